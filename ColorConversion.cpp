@@ -0,0 +1,143 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ColorConversion.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace Gui3DQt {
+namespace ColorConversion {
+
+// BT.601 limited range in 8bit fixed point:
+//   Y = ( 66R + 129G +  25B + 128)/256 +  16
+//   U = (-38R -  74G + 112B + 128)/256 + 128
+//   V = (112R -  94G -  18B + 128)/256 + 128
+// chroma is computed from the sum of a 2x2 block, i.e. divided by 1024
+
+static inline unsigned char luma(const unsigned char *p)
+{
+  return (unsigned char)(((66*p[2] + 129*p[1] + 25*p[0] + 128) >> 8) + 16);
+}
+
+static inline void chroma(const unsigned char *p0, const unsigned char *p1, unsigned char &u, unsigned char &v)
+{
+  int b = p0[0] + p0[4] + p1[0] + p1[4];
+  int g = p0[1] + p0[5] + p1[1] + p1[5];
+  int r = p0[2] + p0[6] + p1[2] + p1[6];
+  u = (unsigned char)(((-38*r - 74*g + 112*b + 512) >> 10) + 128);
+  v = (unsigned char)(((112*r - 94*g - 18*b + 512) >> 10) + 128);
+}
+
+#ifdef __SSE2__
+// sums adjacent 32bit lanes of two madd results: [a0,b0,a1,b1],[a2,b2,a3,b3] -> [a0+b0,a1+b1,a2+b2,a3+b3]
+static inline __m128i hadd_pairs(__m128i lo, __m128i hi)
+{
+  lo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(3,1,2,0)); // a0,a1,b0,b1
+  hi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3,1,2,0)); // a2,a3,b2,b3
+  return _mm_add_epi32(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+}
+
+// converts 8 pixels to 8 luma values
+static inline __m128i luma8(__m128i px0123, __m128i px4567)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i coeff = _mm_set_epi16(0, 66, 129, 25, 0, 66, 129, 25); // X,R,G,B
+  const __m128i round = _mm_set1_epi32(128);
+  __m128i y0 = hadd_pairs(_mm_madd_epi16(_mm_unpacklo_epi8(px0123, zero), coeff),
+                          _mm_madd_epi16(_mm_unpackhi_epi8(px0123, zero), coeff));
+  __m128i y1 = hadd_pairs(_mm_madd_epi16(_mm_unpacklo_epi8(px4567, zero), coeff),
+                          _mm_madd_epi16(_mm_unpackhi_epi8(px4567, zero), coeff));
+  y0 = _mm_srai_epi32(_mm_add_epi32(y0, round), 8);
+  y1 = _mm_srai_epi32(_mm_add_epi32(y1, round), 8);
+  __m128i y = _mm_add_epi16(_mm_packs_epi32(y0, y1), _mm_set1_epi16(16));
+  return _mm_packus_epi16(y, y); // 8 valid bytes in the lower half
+}
+
+// sums 2x2 blocks of 4 pixels in two rows: result holds B,G,R,X sums of block 0 and 1 as 16bit values
+static inline __m128i block_sums(__m128i row0, __m128i row1)
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(row0, zero), _mm_unpacklo_epi8(row1, zero)); // px0,px1
+  __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(row0, zero), _mm_unpackhi_epi8(row1, zero)); // px2,px3
+  lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8)); // block 0 in lower 64 bit
+  hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8)); // block 1 in lower 64 bit
+  return _mm_unpacklo_epi64(lo, hi);
+}
+
+// converts 4 block sums (2 registers from block_sums) into 4 chroma values using coeff
+static inline int chroma4(__m128i blk01, __m128i blk23, __m128i coeff)
+{
+  const __m128i round = _mm_set1_epi32(512);
+  __m128i c = hadd_pairs(_mm_madd_epi16(blk01, coeff), _mm_madd_epi16(blk23, coeff));
+  c = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(c, round), 10), _mm_set1_epi32(128));
+  c = _mm_packs_epi32(c, c);
+  return _mm_cvtsi128_si32(_mm_packus_epi16(c, c));
+}
+#endif
+
+void bgrx_to_yuv420(const unsigned char *bgrx, int stride, int width, int height,
+                    unsigned char *y, unsigned char *u, unsigned char *v)
+{
+  const int cw = width/2;
+  for (int row=0; row<height; row+=2) {
+    const unsigned char *src0 = bgrx + row*stride;
+    const unsigned char *src1 = src0 + stride;
+    unsigned char *y0 = y + row*width;
+    unsigned char *y1 = y0 + width;
+    unsigned char *ur = u + (row/2)*cw;
+    unsigned char *vr = v + (row/2)*cw;
+    int col = 0;
+#ifdef __SSE2__
+    const __m128i ucoeff = _mm_set_epi16(0, -38, -74, 112, 0, -38, -74, 112); // X,R,G,B
+    const __m128i vcoeff = _mm_set_epi16(0, 112, -94, -18, 0, 112, -94, -18);
+    for (; col+8<=width; col+=8) {
+      __m128i a0 = _mm_loadu_si128((const __m128i*)(src0 + 4*col));
+      __m128i a1 = _mm_loadu_si128((const __m128i*)(src0 + 4*col + 16));
+      __m128i b0 = _mm_loadu_si128((const __m128i*)(src1 + 4*col));
+      __m128i b1 = _mm_loadu_si128((const __m128i*)(src1 + 4*col + 16));
+      _mm_storel_epi64((__m128i*)(y0 + col), luma8(a0, a1));
+      _mm_storel_epi64((__m128i*)(y1 + col), luma8(b0, b1));
+      __m128i blk01 = block_sums(a0, b0);
+      __m128i blk23 = block_sums(a1, b1);
+      int uu = chroma4(blk01, blk23, ucoeff);
+      int vv = chroma4(blk01, blk23, vcoeff);
+      for (int i=0; i<4; ++i) {
+        ur[col/2+i] = (unsigned char)(uu >> (8*i));
+        vr[col/2+i] = (unsigned char)(vv >> (8*i));
+      }
+    }
+#endif
+    for (; col<width; col+=2) {
+      const unsigned char *p0 = src0 + 4*col;
+      const unsigned char *p1 = src1 + 4*col;
+      y0[col] = luma(p0);
+      y0[col+1] = luma(p0+4);
+      y1[col] = luma(p1);
+      y1[col+1] = luma(p1+4);
+      chroma(p0, p1, ur[col/2], vr[col/2]);
+    }
+  }
+}
+
+}
+}
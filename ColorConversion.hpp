@@ -0,0 +1,41 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   ColorConversion.hpp
+ *  \brief  Provides pixel format conversion kernels (SSE2 if available)
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_COLORCONVERSION_HPP_
+#define GUI3DQT_COLORCONVERSION_HPP_
+
+namespace Gui3DQt {
+namespace ColorConversion {
+
+  /*! Converts 32bit pixels (byte order B,G,R,X as in QImage::Format_RGB32 on little endian machines)
+   *  to planar YUV 4:2:0 with BT.601 coefficients in limited range (Y 16..235, U/V 16..240).
+   *  width and height must be even, the planes must hold width*height and width*height/4 bytes.
+   */
+  void bgrx_to_yuv420(const unsigned char *bgrx, int stride, int width, int height,
+                      unsigned char *y, unsigned char *u, unsigned char *v);
+
+}
+}
+
+#endif // GUI3DQT_COLORCONVERSION_HPP_
@@ -0,0 +1,278 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Gui3DQt/CoordinateFrameInstances.hpp"
+#include "Gui3DQt/graphics.hpp"
+#include "Instancing.hpp"
+
+#include <math.h>
+#include <stddef.h>
+#include <iostream>
+#include <QtOpenGL/QGLShaderProgram>
+
+using namespace std;
+
+namespace Gui3DQt {
+
+// transforms the mesh by the per-instance 3x4 matrix, shading similar to a head light
+static const char *frameVertexShader =
+  "#version 120\n"
+  "attribute vec3 position;\n"
+  "attribute vec3 normal;\n"
+  "attribute vec4 color;\n"
+  "attribute vec3 col0;\n"
+  "attribute vec3 col1;\n"
+  "attribute vec3 col2;\n"
+  "attribute vec3 col3;\n"
+  "void main() {\n"
+  "  mat3 r = mat3(col0, col1, col2);\n"
+  "  vec3 n = normalize(gl_NormalMatrix * (r * normal));\n"
+  "  gl_FrontColor = vec4(color.rgb * (0.4 + 0.6*abs(n.z)), color.a);\n"
+  "  gl_Position = gl_ModelViewProjectionMatrix * vec4(r * position + col3, 1.0);\n"
+  "}\n";
+
+static const char *frameFragmentShader =
+  "void main() {\n"
+  "  gl_FragColor = gl_Color;\n"
+  "}\n";
+
+// rotations of the arrow (along -z) to the x-, y- and z-axis, as in draw_coordinate_frame()
+static void rotate_to_axis(int axis, const float *in, GLfloat *out)
+{
+  switch (axis) {
+    case 0:  out[0] = -in[2]; out[1] =  in[1]; out[2] =  in[0]; break; // -90deg around y
+    case 1:  out[0] =  in[0]; out[1] = -in[2]; out[2] =  in[1]; break; // 90deg around x
+    default: out[0] =  in[0]; out[1] = -in[1]; out[2] = -in[2]; break; // 180deg around x
+  }
+}
+
+CoordinateFrameInstances::CoordinateFrameInstances()
+  : dirty(false)
+  , initialized(false)
+  , nbMeshVertices(0)
+  , mesh(QGLBuffer::VertexBuffer)
+  , instanceBuffer(QGLBuffer::VertexBuffer)
+  , instanceCapacity(0)
+  , nbInstances(0)
+  , program(NULL)
+  , instancing(NULL)
+{
+}
+
+CoordinateFrameInstances::~CoordinateFrameInstances()
+{
+  delete program;
+  delete instancing;
+  instanceBuffer.destroy();
+  mesh.destroy();
+}
+
+void CoordinateFrameInstances::clear()
+{
+  instances.clear();
+  dirty = true;
+}
+
+size_t CoordinateFrameInstances::size() const
+{
+  return instances.size();
+}
+
+void CoordinateFrameInstances::reserve(size_t nbFrames)
+{
+  instances.reserve(nbFrames);
+}
+
+void CoordinateFrameInstances::add(double x, double y, double z, double roll, double pitch, double yaw, double scale)
+{
+  const double cr = cos(roll), sr = sin(roll);
+  const double cp = cos(pitch), sp = sin(pitch);
+  const double cy = cos(yaw), sy = sin(yaw);
+  const double transform[16] = {
+    cy*cp, sy*cp, -sp, 0,
+    cy*sp*sr - sy*cr, sy*sp*sr + cy*cr, cp*sr, 0,
+    cy*sp*cr + sy*sr, sy*sp*cr - cy*sr, cp*cr, 0,
+    x, y, z, 1};
+  add(transform, scale);
+}
+
+void CoordinateFrameInstances::add(const double *transform, double scale)
+{
+  Instance i;
+  for (int c=0; c<3; ++c)
+    for (int r=0; r<3; ++r)
+      i.m[3*c+r] = transform[4*c+r] * scale;
+  for (int r=0; r<3; ++r)
+    i.m[9+r] = transform[12+r];
+  instances.push_back(i);
+  dirty = true;
+}
+
+void CoordinateFrameInstances::initialize()
+{
+  initialized = true;
+  const float *triVertices, *triNormals, *quadVertices, *quadNormals;
+  int nbTriangles, nbQuads;
+  Graphics::coordinate_frame_arrow(&triVertices, &triNormals, &nbTriangles, &quadVertices, &quadNormals, &nbQuads);
+
+  vector<Vertex> vertices;
+  vertices.reserve(3*(3*nbTriangles + 6*nbQuads));
+  for (int axis=0; axis<3; ++axis) {
+    Vertex v;
+    v.r = (axis == 0) ? 255 : 0;
+    v.g = (axis == 1) ? 255 : 0;
+    v.b = (axis == 2) ? 255 : 0;
+    v.a = 255;
+    for (int i=0; i<3*nbTriangles; ++i) {
+      rotate_to_axis(axis, triVertices + 3*i, &v.x);
+      rotate_to_axis(axis, triNormals + 3*i, &v.nx);
+      vertices.push_back(v);
+    }
+    const int quadToTriangles[6] = {0,1,2,0,2,3};
+    for (int q=0; q<nbQuads; ++q) {
+      for (int k=0; k<6; ++k) {
+        int i = 4*q + quadToTriangles[k];
+        rotate_to_axis(axis, quadVertices + 3*i, &v.x);
+        rotate_to_axis(axis, quadNormals + 3*i, &v.nx);
+        vertices.push_back(v);
+      }
+    }
+  }
+  if (!mesh.create())
+    return;
+  mesh.setUsagePattern(QGLBuffer::StaticDraw);
+  mesh.bind();
+  mesh.allocate(&vertices[0], vertices.size()*sizeof(Vertex));
+  mesh.release();
+  nbMeshVertices = vertices.size();
+
+  instancing = new Instancing::Functions();
+  if (!Instancing::resolve(instancing->drawArraysInstanced, instancing->vertexAttribDivisor)) {
+    cout << "CoordinateFrameInstances: instancing not supported, drawing frames one by one" << endl;
+    return;
+  }
+  program = new QGLShaderProgram();
+  program->bindAttributeLocation("position", 0); // attribute 0 must not be instanced
+  if (!program->addShaderFromSourceCode(QGLShader::Vertex, frameVertexShader)
+      || !program->addShaderFromSourceCode(QGLShader::Fragment, frameFragmentShader)
+      || !program->link()) {
+    cerr << "CoordinateFrameInstances: instancing shader not available, drawing frames one by one" << endl << program->log().toStdString() << endl;
+    delete program;
+    program = NULL;
+  }
+}
+
+void CoordinateFrameInstances::upload()
+{
+  GLsizei total = instances.size();
+  if (!instanceBuffer.isCreated()) {
+    if (!instanceBuffer.create())
+      return;
+    instanceBuffer.setUsagePattern(QGLBuffer::DynamicDraw);
+  }
+  instanceBuffer.bind();
+  if (total > instanceCapacity) { // grow, otherwise the storage is reused
+    instanceCapacity = total + total/2;
+    instanceBuffer.allocate(instanceCapacity*sizeof(Instance));
+  }
+  if (total > 0)
+    instanceBuffer.write(0, &instances[0], total*sizeof(Instance));
+  instanceBuffer.release();
+  nbInstances = total;
+  dirty = false;
+}
+
+void CoordinateFrameInstances::renderInstanced()
+{
+  const char *columns[4] = {"col0", "col1", "col2", "col3"};
+  const int stride = sizeof(Vertex);
+  program->bind();
+  mesh.bind();
+  program->setAttributeBuffer("position", GL_FLOAT, offsetof(Vertex, x), 3, stride);
+  program->setAttributeBuffer("normal", GL_FLOAT, offsetof(Vertex, nx), 3, stride);
+  program->setAttributeBuffer("color", GL_UNSIGNED_BYTE, offsetof(Vertex, r), 4, stride);
+  mesh.release();
+  program->enableAttributeArray("position");
+  program->enableAttributeArray("normal");
+  program->enableAttributeArray("color");
+  instanceBuffer.bind();
+  for (int c=0; c<4; ++c) {
+    program->setAttributeBuffer(columns[c], GL_FLOAT, 3*c*sizeof(GLfloat), 3, sizeof(Instance));
+    program->enableAttributeArray(columns[c]);
+    instancing->vertexAttribDivisor(program->attributeLocation(columns[c]), 1);
+  }
+  instanceBuffer.release();
+  instancing->drawArraysInstanced(GL_TRIANGLES, 0, nbMeshVertices, nbInstances);
+  for (int c=0; c<4; ++c) {
+    instancing->vertexAttribDivisor(program->attributeLocation(columns[c]), 0);
+    program->disableAttributeArray(columns[c]);
+  }
+  program->disableAttributeArray("color");
+  program->disableAttributeArray("normal");
+  program->disableAttributeArray("position");
+  program->release();
+}
+
+void CoordinateFrameInstances::renderLoop()
+{
+  mesh.bind();
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_NORMAL_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+  glVertexPointer(3, GL_FLOAT, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, x));
+  glNormalPointer(GL_FLOAT, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, nx));
+  glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, r));
+  mesh.release();
+  for (vector<Instance>::const_iterator i = instances.begin(); i != instances.end(); ++i) {
+    const GLfloat m[16] = {
+      i->m[0], i->m[1], i->m[2], 0,
+      i->m[3], i->m[4], i->m[5], 0,
+      i->m[6], i->m[7], i->m[8], 0,
+      i->m[9], i->m[10], i->m[11], 1};
+    glPushMatrix();
+    glMultMatrixf(m);
+    glDrawArrays(GL_TRIANGLES, 0, nbMeshVertices);
+    glPopMatrix();
+  }
+}
+
+void CoordinateFrameInstances::render()
+{
+  if (!initialized)
+    initialize();
+  if (!mesh.isCreated())
+    return;
+  if (program && dirty)
+    upload();
+  if (instances.empty())
+    return;
+  glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+  glDisable(GL_TEXTURE_2D);
+  if (program)
+    renderInstanced();
+  else
+    renderLoop();
+  glPopClientAttrib();
+  glPopAttrib();
+}
+
+} // namespace
@@ -0,0 +1,75 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Gui3DQt/EllipseInstances.hpp"
+#include "Gui3DQt/graphics.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace Gui3DQt {
+
+EllipseInstances::EllipseInstances(int segments)
+{
+  fillShape = addShape(GL_TRIANGLE_FAN, unitCircle(segments, true));
+  outlineShape = addShape(GL_LINE_LOOP, unitCircle(segments, false));
+}
+
+EllipseInstances::~EllipseInstances()
+{
+}
+
+vector<GLfloat> EllipseInstances::unitCircle(int segments, bool filled)
+{
+  segments = max(3, segments);
+  vector<GLfloat> xy;
+  xy.reserve(2*(segments+2));
+  if (filled) {
+    xy.push_back(0); xy.push_back(0); // fan center
+  }
+  const double *c = Graphics::unit_circle(segments);
+  xy.insert(xy.end(), c, c + 2*segments);
+  if (filled) { // close the fan
+    xy.push_back(1); xy.push_back(0);
+  }
+  return xy;
+}
+
+void EllipseInstances::addCircle(double x, double y, double r, bool filled, double z)
+{
+  addInstance(filled ? fillShape : outlineShape, x, y, 0, r, r, z);
+}
+
+void EllipseInstances::addEllipse(double x, double y, double rx, double ry, double theta, bool filled, double z)
+{
+  addInstance(filled ? fillShape : outlineShape, x, y, theta, rx, ry, z);
+}
+
+void EllipseInstances::addRings(double x, double y, double max_distance, double distance_increment, double z)
+{
+  if (distance_increment <= 0)
+    return;
+  for (double r = distance_increment; r <= max_distance; r += distance_increment)
+    addInstance(outlineShape, x, y, 0, r, r, z);
+}
+
+} // namespace
@@ -0,0 +1,396 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Gui3DQt/FleetRenderer.hpp"
+#include "Gui3DQt/GLState.hpp"
+#include "models3d.hpp"
+#include "Instancing.hpp"
+
+#include <math.h>
+#include <stddef.h>
+#include <algorithm>
+#include <iostream>
+#include <QtOpenGL/QGLShaderProgram>
+
+using namespace std;
+
+namespace Gui3DQt {
+
+// transforms the model by the per-instance 3x4 matrix and evaluates light 0 with the current material,
+// the diffuse color is replaced by the instance color for the body material
+static const char *fleetVertexShader =
+  "#version 120\n"
+  "attribute vec3 position;\n"
+  "attribute vec3 normal;\n"
+  "attribute vec3 col0;\n"
+  "attribute vec3 col1;\n"
+  "attribute vec3 col2;\n"
+  "attribute vec3 col3;\n"
+  "attribute vec4 color;\n"
+  "uniform int useInstanceColor;\n"
+  "void main() {\n"
+  "  mat3 r = mat3(col0, col1, col2);\n"
+  "  vec4 p = gl_ModelViewMatrix * vec4(r * position + col3, 1.0);\n"
+  "  vec3 n = normalize(gl_NormalMatrix * (r * normal));\n"
+  "  vec4 diffuse = (useInstanceColor != 0) ? vec4(color.rgb, gl_FrontMaterial.diffuse.a) : gl_FrontMaterial.diffuse;\n"
+  "  vec3 l = normalize(gl_LightSource[0].position.xyz - p.xyz * gl_LightSource[0].position.w);\n"
+  "  float nl = max(dot(n, l), 0.0);\n"
+  "  float spec = (nl > 0.0) ? pow(max(dot(n, normalize(gl_LightSource[0].halfVector.xyz)), 0.0), gl_FrontMaterial.shininess) : 0.0;\n"
+  "  vec4 c = gl_FrontLightModelProduct.sceneColor + gl_LightSource[0].ambient * gl_FrontMaterial.ambient\n"
+  "         + gl_LightSource[0].diffuse * diffuse * nl + gl_LightSource[0].specular * gl_FrontMaterial.specular * spec;\n"
+  "  gl_FrontColor = vec4(c.rgb, diffuse.a);\n"
+  "  gl_Position = gl_ProjectionMatrix * p;\n"
+  "}\n";
+
+static const char *fleetFragmentShader =
+  "void main() {\n"
+  "  gl_FragColor = gl_Color;\n"
+  "}\n";
+
+// 3x4 affine transforms, column-major: out = a*b
+static void multiply(const GLfloat *a, const GLfloat *b, GLfloat *out)
+{
+  for (int c=0; c<4; ++c)
+    for (int r=0; r<3; ++r)
+      out[3*c+r] = a[r]*b[3*c] + a[3+r]*b[3*c+1] + a[6+r]*b[3*c+2] + ((c == 3) ? a[9+r] : 0);
+}
+
+static void scale_translate(GLfloat s, GLfloat x, GLfloat y, GLfloat z, GLfloat *m)
+{
+  const GLfloat t[12] = {s,0,0, 0,s,0, 0,0,s, s*x,s*y,s*z}; // S(s)*T(x,y,z)
+  std::copy(t, t+12, m);
+}
+
+static void rotation_z(double angle, GLfloat *m)
+{
+  const GLfloat c = cos(angle), s = sin(angle);
+  const GLfloat t[12] = {c,s,0, -s,c,0, 0,0,1, 0,0,0};
+  std::copy(t, t+12, m);
+}
+
+static void rotation_y(double angle, GLfloat *m)
+{
+  const GLfloat c = cos(angle), s = sin(angle);
+  const GLfloat t[12] = {c,0,-s, 0,1,0, s,0,c, 0,0,0};
+  std::copy(t, t+12, m);
+}
+
+FleetRenderer::FleetRenderer()
+  : dirty(false)
+  , initialized(false)
+  , program(NULL)
+  , instancing(NULL)
+{
+  for (int p=0; p<NB_PARTS; ++p)
+    instanceCapacity[p] = 0;
+  for (int l=0; l<=ModelAssets::NB_LODS; ++l)
+    lodFirst[l] = 0;
+  ModelAssets::instance().preload(); // prepared in the background until the first render()
+}
+
+FleetRenderer::~FleetRenderer()
+{
+  delete program;
+  delete instancing;
+  for (int p=0; p<NB_PARTS; ++p)
+    instanceBuffers[p].destroy();
+}
+
+void FleetRenderer::clear()
+{
+  vehicles.clear();
+  dirty = true;
+}
+
+size_t FleetRenderer::size() const
+{
+  return vehicles.size();
+}
+
+void FleetRenderer::reserve(size_t nbVehicles)
+{
+  vehicles.reserve(nbVehicles);
+}
+
+void FleetRenderer::add(const Vehicle &vehicle)
+{
+  vehicles.push_back(vehicle);
+  dirty = true;
+}
+
+void FleetRenderer::setVehicles(const std::vector<Vehicle> &v)
+{
+  vehicles = v;
+  dirty = true;
+}
+
+void FleetRenderer::initialize()
+{
+  initialized = true;
+  ModelAssets &assets = ModelAssets::instance();
+  for (int l=0; l<ModelAssets::NB_LODS; ++l) {
+    models[BODY][l] = assets.get(ModelAssets::PASSAT, l);
+    models[TIRES][l] = assets.get(ModelAssets::TIRE, l);
+    models[VELODYNE][l] = assets.get(ModelAssets::VELODYNE, l);
+  }
+
+  instancing = new Instancing::Functions();
+  if (!Instancing::resolve(instancing->drawElementsInstanced, instancing->vertexAttribDivisor)) {
+    cout << "FleetRenderer: instancing not supported, drawing vehicles one by one" << endl;
+    return;
+  }
+  program = new QGLShaderProgram();
+  program->bindAttributeLocation("position", 0); // attribute 0 must not be instanced
+  if (!program->addShaderFromSourceCode(QGLShader::Vertex, fleetVertexShader)
+      || !program->addShaderFromSourceCode(QGLShader::Fragment, fleetFragmentShader)
+      || !program->link()) {
+    cerr << "FleetRenderer: instancing shader not available, drawing vehicles one by one" << endl << program->log().toStdString() << endl;
+    delete program;
+    program = NULL;
+  }
+}
+
+void FleetRenderer::computeInstances()
+{
+  // placement of the parts relative to the vehicle, as in PassatModel::draw()
+  const GLfloat tirePos[4][3] = {{2.27,-1.17,-0.86}, {2.27,1.17,-0.86}, {-2.05,-1.17,-0.86}, {-2.05,1.17,-0.86}};
+  GLfloat bodyLocal[12], flip[12], tmp[12], local[12];
+  scale_translate(5.0, 0, 0, 0, tmp);
+  rotation_z(M_PI, flip);
+  multiply(tmp, flip, bodyLocal);
+
+  for (int p=0; p<NB_PARTS; ++p)
+    instances[p].resize(((p == TIRES) ? 4 : 1) * vehicles.size());
+  lods.assign(vehicles.size(), -1); // assigned by selectLods()
+  for (size_t v=0; v<vehicles.size(); ++v) {
+    const Vehicle &veh = vehicles[v];
+    const double cr = cos(veh.roll), sr = sin(veh.roll);
+    const double cp = cos(veh.pitch), sp = sin(veh.pitch);
+    const double cy = cos(veh.yaw), sy = sin(veh.yaw);
+    const GLfloat pose[12] = {
+      (GLfloat)(cy*cp), (GLfloat)(sy*cp), (GLfloat)(-sp),
+      (GLfloat)(cy*sp*sr - sy*cr), (GLfloat)(sy*sp*sr + cy*cr), (GLfloat)(cp*sr),
+      (GLfloat)(cy*sp*cr + sy*sr), (GLfloat)(sy*sp*cr - cy*sr), (GLfloat)(cp*cr),
+      (GLfloat)veh.x, (GLfloat)veh.y, (GLfloat)veh.z};
+
+    Instance &body = instances[BODY][v];
+    multiply(pose, bodyLocal, body.m);
+    body.rgba[0] = (GLubyte)(255*min(max(veh.r, 0.f), 1.f));
+    body.rgba[1] = (GLubyte)(255*min(max(veh.g, 0.f), 1.f));
+    body.rgba[2] = (GLubyte)(255*min(max(veh.b, 0.f), 1.f));
+    body.rgba[3] = 255;
+
+    for (int t=0; t<4; ++t) {
+      GLfloat wheel[12];
+      scale_translate(0.65, tirePos[t][0], tirePos[t][1], tirePos[t][2], tmp);
+      if (t % 2) { // left tires are mirrored
+        multiply(tmp, flip, local);
+        rotation_y(-veh.wheelAngle, wheel);
+      } else {
+        std::copy(tmp, tmp+12, local);
+        rotation_y(veh.wheelAngle, wheel);
+      }
+      multiply(local, wheel, tmp);
+      Instance &tire = instances[TIRES][4*v+t];
+      multiply(pose, tmp, tire.m);
+      std::copy(body.rgba, body.rgba+4, tire.rgba);
+    }
+
+    GLfloat spin[12];
+    scale_translate(0.65*0.35, -0.34, 0, 3.6, tmp);
+    rotation_z(veh.velodyneAngle + M_PI, spin);
+    multiply(tmp, spin, local);
+    Instance &velodyne = instances[VELODYNE][v];
+    multiply(pose, local, velodyne.m);
+    std::copy(body.rgba, body.rgba+4, velodyne.rgba);
+  }
+}
+
+bool FleetRenderer::selectLods()
+{
+  GLdouble modelview[16], projection[16];
+  GLint viewport[4];
+  glGetDoublev(GL_MODELVIEW_MATRIX, modelview); // the placement of the fleet is not known to GLState
+  GLState &state = GLState::current();
+  state.getProjectionMatrix(projection);
+  state.getViewport(viewport);
+  const bool perspective = (projection[15] == 0);
+  const double pixels = 5.0 * sqrt(modelview[0]*modelview[0] + modelview[1]*modelview[1] + modelview[2]*modelview[2])
+                        * projection[5] * viewport[3] / 2; // projected vehicle length at distance 1, as PassatModel::levelOfDetail()
+  GLsizei counts[ModelAssets::NB_LODS] = {0};
+  bool changed = false;
+  for (size_t v=0; v<vehicles.size(); ++v) {
+    int lod = 0;
+    if (perspective) {
+      const Vehicle &veh = vehicles[v];
+      const double distance = -(modelview[2]*veh.x + modelview[6]*veh.y + modelview[10]*veh.z + modelview[14]);
+      if (distance > 0)
+        lod = ModelAssets::levelOfDetail(pixels / distance);
+    } else {
+      lod = ModelAssets::levelOfDetail(pixels);
+    }
+    changed |= (lods[v] != lod);
+    lods[v] = lod;
+    ++counts[lod];
+  }
+  for (int l=0; l<ModelAssets::NB_LODS; ++l)
+    lodFirst[l+1] = lodFirst[l] + counts[l];
+  return changed;
+}
+
+void FleetRenderer::upload()
+{
+  for (int p=0; p<NB_PARTS; ++p) {
+    GLsizei total = instances[p].size();
+    if (!instanceBuffers[p].isCreated()) {
+      if (!instanceBuffers[p].create())
+        return;
+      instanceBuffers[p].setUsagePattern(QGLBuffer::DynamicDraw);
+    }
+    // vehicles ordered by level of detail, so each level is drawn from a contiguous range
+    const int k = (p == TIRES) ? 4 : 1; // instances per vehicle
+    GLsizei next[ModelAssets::NB_LODS];
+    std::copy(lodFirst, lodFirst+ModelAssets::NB_LODS, next);
+    staging.resize(total);
+    for (size_t v=0; v<vehicles.size(); ++v)
+      std::copy(&instances[p][k*v], &instances[p][k*v] + k, &staging[k*next[lods[v]]++]);
+    instanceBuffers[p].bind();
+    if (total > instanceCapacity[p]) { // grow, otherwise the storage is reused
+      instanceCapacity[p] = total + total/2;
+      instanceBuffers[p].allocate(instanceCapacity[p]*sizeof(Instance));
+    }
+    if (total > 0)
+      instanceBuffers[p].write(0, &staging[0], total*sizeof(Instance));
+    instanceBuffers[p].release();
+  }
+}
+
+void FleetRenderer::renderInstanced(int selection)
+{
+  const char *columns[4] = {"col0", "col1", "col2", "col3"};
+  program->bind();
+  for (int c=0; c<4; ++c) {
+    program->enableAttributeArray(columns[c]);
+    instancing->vertexAttribDivisor(program->attributeLocation(columns[c]), 1);
+  }
+  program->enableAttributeArray("color");
+  instancing->vertexAttribDivisor(program->attributeLocation("color"), 1);
+  for (int p=0; p<NB_PARTS; ++p) {
+    const int k = (p == TIRES) ? 4 : 1; // instances per vehicle
+    for (int l=0; l<ModelAssets::NB_LODS; ++l) {
+      const GLsizei nbInstances = k*(lodFirst[l+1] - lodFirst[l]);
+      if ((nbInstances == 0) || !models[p][l]->hasGroups(selection))
+        continue;
+      const size_t offset = k*lodFirst[l]*sizeof(Instance); // no base instance in GL 3.x, the attributes start at the level
+      instanceBuffers[p].bind();
+      for (int c=0; c<4; ++c)
+        program->setAttributeBuffer(columns[c], GL_FLOAT, offset + 3*c*sizeof(GLfloat), 3, sizeof(Instance));
+      program->setAttributeBuffer("color", GL_UNSIGNED_BYTE, offset + offsetof(Instance, rgba), 4, sizeof(Instance));
+      instanceBuffers[p].release();
+      models[p][l]->drawInstanced(*program, instancing->drawElementsInstanced, nbInstances, (p == BODY) ? PASSAT_BODY_MATERIAL : -1, selection);
+    }
+  }
+  for (int c=0; c<4; ++c) {
+    instancing->vertexAttribDivisor(program->attributeLocation(columns[c]), 0);
+    program->disableAttributeArray(columns[c]);
+  }
+  instancing->vertexAttribDivisor(program->attributeLocation("color"), 0);
+  program->disableAttributeArray("color");
+  program->release();
+}
+
+void FleetRenderer::renderLoop(int selection)
+{
+  glEnable(GL_LIGHTING);
+  glEnable(GL_NORMALIZE);
+  for (int p=0; p<NB_PARTS; ++p) {
+    const int k = (p == TIRES) ? 4 : 1; // instances per vehicle
+    for (size_t v=0; v<vehicles.size(); ++v) {
+      IndexedModel &model = *models[p][lods[v]];
+      if (!model.hasGroups(selection))
+        continue;
+      for (int j=0; j<k; ++j) {
+        const Instance *i = &instances[p][k*v+j];
+        const GLfloat m[16] = {
+          i->m[0], i->m[1], i->m[2], 0,
+          i->m[3], i->m[4], i->m[5], 0,
+          i->m[6], i->m[7], i->m[8], 0,
+          i->m[9], i->m[10], i->m[11], 1};
+        const GLfloat color[3] = {i->rgba[0]/255.f, i->rgba[1]/255.f, i->rgba[2]/255.f};
+        glPushMatrix();
+        glMultMatrixf(m);
+        if (p == BODY)
+          model.draw(PASSAT_BODY_MATERIAL, color, selection);
+        else
+          model.draw(-1, NULL, selection);
+        glPopMatrix();
+      }
+    }
+  }
+}
+
+void FleetRenderer::render()
+{
+  render(IndexedModel::ALL_GROUPS);
+}
+
+void FleetRenderer::renderOpaque()
+{
+  render(IndexedModel::OPAQUE_GROUPS);
+}
+
+void FleetRenderer::renderTranslucent()
+{
+  render(IndexedModel::TRANSLUCENT_GROUPS);
+}
+
+void FleetRenderer::render(int selection)
+{
+  if (!initialized)
+    initialize();
+  for (int p=0; p<NB_PARTS; ++p)
+    for (int l=0; l<ModelAssets::NB_LODS; ++l)
+      if (!models[p][l])
+        return;
+  if (dirty)
+    computeInstances();
+  const bool lodsChanged = selectLods(); // the camera may have moved
+  if (program && (dirty || lodsChanged))
+    upload();
+  dirty = false;
+  if (vehicles.empty())
+    return;
+  glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+  glEnable(GL_DEPTH_TEST);
+  glDisable(GL_TEXTURE_2D);
+  const int passes[2] = {IndexedModel::OPAQUE_GROUPS, IndexedModel::TRANSLUCENT_GROUPS};
+  for (int p=0; p<2; ++p) {
+    if (!(selection & passes[p]))
+      continue;
+    if (program)
+      renderInstanced(passes[p]);
+    else
+      renderLoop(passes[p]);
+  }
+  glPopAttrib();
+}
+
+} // namespace
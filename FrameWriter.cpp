@@ -0,0 +1,426 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Gui3DQt/FrameWriter.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#ifndef WIN32
+#include <signal.h>
+#include <pthread.h>
+#endif
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/format.hpp>
+#include <boost/bind.hpp>
+
+#include "ColorConversion.hpp"
+
+#ifdef WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+#define DEFAULT_ENCODER_COMMAND "ffmpeg -loglevel error -y -f yuv4mpegpipe -i - -c:v libx264 -preset veryfast -crf 18 '%1.mp4'"
+#define DEFAULT_STREAM_FPS 25
+#define STREAM_BUFFER_SIZE (1<<20)
+
+using namespace std;
+namespace fs = boost::filesystem;
+
+namespace Gui3DQt {
+
+FrameWriter::FrameWriter(unsigned int nbThreads, unsigned int queueSize)
+  : capacity(max(1u, queueSize))
+  , busyWorkers(0)
+  , stopping(false)
+  , filePattern("img*.png")
+  , format(FF_Auto)
+  , policy(QP_Block)
+  , counterValid(false)
+  , frameCounter(0)
+  , dropped(0)
+  , sink(OS_Images)
+  , encoderCommand(DEFAULT_ENCODER_COMMAND)
+  , streamFps(DEFAULT_STREAM_FPS)
+  , streamWidth(0)
+  , streamHeight(0)
+  , streamSequence(0)
+  , streamNextWrite(0)
+  , stream(NULL)
+  , streamIsPipe(false)
+  , streamFailed(false)
+{
+  for (unsigned int i=0; i<max(1u, nbThreads); ++i)
+    workers.create_thread(boost::bind(&FrameWriter::work, this));
+}
+
+FrameWriter::~FrameWriter()
+{
+  {
+    boost::mutex::scoped_lock lock(mutex);
+    stopping = true;
+  }
+  queueNotEmpty.notify_all();
+  workers.join_all(); // workers return once the queue is empty
+  closeStreamFile();
+}
+
+void FrameWriter::setOutput(const fs::path &dir, const string &pattern)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  outputDirectory = dir;
+  filePattern = pattern;
+  counterValid = false;
+  dropped = 0;
+}
+
+void FrameWriter::setFormat(Format fmt)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  format = fmt;
+}
+
+FrameWriter::Format FrameWriter::getFormat() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return format;
+}
+
+void FrameWriter::setQueuePolicy(QueuePolicy p)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  policy = p;
+}
+
+FrameWriter::QueuePolicy FrameWriter::getQueuePolicy() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return policy;
+}
+
+void FrameWriter::setSink(Sink s)
+{
+  closeStream();
+  boost::mutex::scoped_lock lock(mutex);
+  sink = s;
+}
+
+FrameWriter::Sink FrameWriter::getSink() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return sink;
+}
+
+void FrameWriter::setEncoderCommand(const string &cmd)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  encoderCommand = cmd;
+}
+
+string FrameWriter::getEncoderCommand() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return encoderCommand;
+}
+
+void FrameWriter::setStreamFrameRate(unsigned int fps)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  streamFps = max(1u, fps);
+}
+
+bool FrameWriter::push(const QImage &frame)
+{
+  return push(frame, getQueuePolicy());
+}
+
+bool FrameWriter::push(const QImage &frame, QueuePolicy p)
+{
+  if (frame.isNull())
+    return false;
+  boost::mutex::scoped_lock lock(mutex);
+  if (queue.size() >= capacity) {
+    switch (p) {
+      case QP_Block:
+        while (queue.size() >= capacity)
+          queueNotFull.wait(lock);
+        break;
+      case QP_DropNewest:
+        ++dropped;
+        return false;
+      case QP_DropOldest:
+        queue.pop_front();
+        ++dropped;
+        break;
+    }
+  }
+  Job job;
+  job.image = frame; // implicitly shared, no pixel copy
+  job.format = format;
+  job.sink = sink;
+  job.sequence = 0;
+  queue.push_back(job);
+  queueNotEmpty.notify_one();
+  return true;
+}
+
+bool FrameWriter::pushStill(const QImage &frame)
+{
+  if (frame.isNull())
+    return false;
+  boost::mutex::scoped_lock lock(mutex);
+  while (queue.size() >= capacity)
+    queueNotFull.wait(lock);
+  Job job;
+  job.image = frame;
+  job.format = format;
+  job.sink = OS_Images;
+  job.sequence = 0;
+  queue.push_back(job);
+  queueNotEmpty.notify_one();
+  return true;
+}
+
+void FrameWriter::flush()
+{
+  boost::mutex::scoped_lock lock(mutex);
+  while (!queue.empty() || (busyWorkers > 0))
+    allDone.wait(lock);
+}
+
+void FrameWriter::closeStream()
+{
+  flush();
+  boost::mutex::scoped_lock lock(mutex);
+  closeStreamFile();
+  streamWidth = 0;
+  streamHeight = 0;
+  streamSequence = 0;
+  streamNextWrite = 0;
+  streamFailed = false;
+}
+
+unsigned int FrameWriter::droppedFrames() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return dropped;
+}
+
+void FrameWriter::work()
+{
+#ifndef WIN32
+  // a terminated encoder process must not kill the application, writing fails with EPIPE instead
+  sigset_t sigpipe;
+  sigemptyset(&sigpipe);
+  sigaddset(&sigpipe, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &sigpipe, NULL);
+#endif
+  while (true) {
+    Job job;
+    string filename;
+    int width = 0, height = 0;
+    {
+      boost::mutex::scoped_lock lock(mutex);
+      while (queue.empty() && !stopping)
+        queueNotEmpty.wait(lock);
+      if (queue.empty()) // stopping
+        return;
+      job = queue.front();
+      queue.pop_front();
+      if (job.sink == OS_Images) {
+        filename = nextFilename(filenamePattern(job.format)); // numbers are assigned in queue order
+      } else {
+        if (streamWidth == 0) { // first frame determines the size of the stream
+          streamWidth = job.image.width() & ~1;
+          streamHeight = job.image.height() & ~1;
+          streamTarget = nextFilename(streamFilenamePattern(job.sink));
+          if (job.sink == OS_EncoderPipe)
+            streamTarget = boost::replace_all_copy(encoderCommand, "%1", boost::replace_all_copy(streamTarget, "'", "'\\''")); // %1 is single-quoted in the command
+        }
+        job.sequence = streamSequence++; // frames are written in queue order
+        width = streamWidth;
+        height = streamHeight;
+      }
+      ++busyWorkers;
+    }
+    queueNotFull.notify_one();
+
+    if (job.sink == OS_Images)
+      writeStill(job, filename);
+    else
+      writeStream(job, width, height);
+
+    {
+      boost::mutex::scoped_lock lock(mutex);
+      --busyWorkers;
+      if (queue.empty() && (busyWorkers == 0))
+        allDone.notify_all();
+    }
+  }
+}
+
+void FrameWriter::writeStill(const Job &job, const string &filename)
+{
+  const char *fmt = NULL; // deduce from filename
+  int quality = -1; // default compression
+  switch (job.format) {
+    case FF_Auto: break;
+    case FF_PNG: fmt = "PNG"; break;
+    case FF_PNGFast: fmt = "PNG"; quality = 80; break; // Qt maps this to zlib level 1
+    case FF_BMP: fmt = "BMP"; break;
+    case FF_PPM: fmt = "PPM"; break;
+  }
+  ostringstream msg; // assemble line first, as several workers write to cout
+  if (job.image.save(QString(filename.c_str()), fmt, quality))
+    msg << "store frame as " << filename << endl;
+  else
+    msg << "FrameWriter: could not write " << filename << endl;
+  cout << msg.str() << std::flush;
+}
+
+void FrameWriter::writeStream(const Job &job, int width, int height)
+{
+  // convert in parallel to the other workers
+  QImage img = job.image;
+  if ((img.width() < width) || (img.width() > width+1) || (img.height() < height) || (img.height() > height+1))
+    img = img.scaled(width, height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+  if ((img.format() != QImage::Format_RGB32) && (img.format() != QImage::Format_ARGB32))
+    img = img.convertToFormat(QImage::Format_RGB32);
+  const size_t lumaSize = (size_t)width*height;
+  vector<unsigned char> yuv(lumaSize*3/2);
+  if (lumaSize > 0)
+    ColorConversion::bgrx_to_yuv420(img.constBits(), img.bytesPerLine(), width, height,
+                                    &yuv[0], &yuv[lumaSize], &yuv[lumaSize*5/4]);
+
+  // wait for our turn, then write without holding the lock
+  boost::mutex::scoped_lock lock(mutex);
+  while (streamNextWrite != job.sequence)
+    streamTurn.wait(lock);
+  string target = streamTarget;
+  unsigned int fps = streamFps;
+  lock.unlock();
+
+  if ((stream == NULL) && !streamFailed)
+    streamFailed = !openStream(job.sink, target, width, height, fps);
+  if (stream != NULL) {
+    // flush here, so a broken pipe is detected by this thread (SIGPIPE is blocked only in the workers)
+    if ((fputs("FRAME\n", stream) < 0) || (fwrite(&yuv[0], 1, yuv.size(), stream) != yuv.size()) || (fflush(stream) != 0)) {
+      ostringstream msg;
+      msg << "FrameWriter: could not write to " << target << endl;
+      cout << msg.str() << std::flush;
+      closeStreamFile();
+      streamFailed = true; // skip remaining frames until closeStream() is called
+    }
+  }
+
+  lock.lock();
+  ++streamNextWrite;
+  streamTurn.notify_all();
+}
+
+bool FrameWriter::openStream(Sink s, const string &target, int width, int height, unsigned int fps)
+{
+  streamIsPipe = (s == OS_EncoderPipe);
+  stream = streamIsPipe ? popen(target.c_str(), "w") : fopen(target.c_str(), "wb");
+  ostringstream msg;
+  if ((stream == NULL) || (width == 0) || (height == 0)) {
+    msg << "FrameWriter: could not open " << target << endl;
+    cout << msg.str() << std::flush;
+    closeStreamFile();
+    return false;
+  }
+  setvbuf(stream, NULL, _IOFBF, STREAM_BUFFER_SIZE); // few large sequential writes
+  fprintf(stream, "YUV4MPEG2 W%d H%d F%u:1 Ip A1:1 C420jpeg\n", width, height, fps);
+  msg << (streamIsPipe ? "pipe frames to " : "store frames in ") << target << endl;
+  cout << msg.str() << std::flush;
+  return true;
+}
+
+void FrameWriter::closeStreamFile()
+{
+  if (stream == NULL)
+    return;
+  if (streamIsPipe) {
+    if (pclose(stream) != 0) // waits for the encoder to finish
+      cout << "FrameWriter: encoder failed: " << streamTarget << endl;
+  } else {
+    fclose(stream);
+  }
+  stream = NULL;
+}
+
+string FrameWriter::filenamePattern(Format fmt) const
+{
+  fs::path fName(filePattern);
+  switch (fmt) {
+    case FF_Auto: break;
+    case FF_PNG:
+    case FF_PNGFast: fName.replace_extension(".png"); break;
+    case FF_BMP: fName.replace_extension(".bmp"); break;
+    case FF_PPM: fName.replace_extension(".ppm"); break;
+  }
+  return fName.string();
+}
+
+string FrameWriter::streamFilenamePattern(Sink s) const
+{
+  fs::path fName(filePattern);
+  fName.replace_extension((s == OS_Y4MFile) ? ".y4m" : ""); // encoder command appends its own extension
+  return fName.string();
+}
+
+string FrameWriter::nextFilename(const string &pattern)
+{
+  string name = pattern;
+  if (!counterValid)
+    scanOutputDirectory(name);
+  string number = (boost::format("%1$05d") % ++frameCounter).str();
+  boost::replace_first(name, "*", number);
+  return (outputDirectory / name).string();
+}
+
+void FrameWriter::scanOutputDirectory(const string &pattern)
+{
+  // continue after the highest number found for this pattern, regardless of the extension
+  frameCounter = 0;
+  counterValid = true;
+  size_t star = pattern.find('*');
+  if (star == string::npos)
+    return;
+  string prefix = pattern.substr(0, star);
+  string suffix = pattern.substr(star+1);
+  suffix = suffix.substr(0, suffix.rfind('.'));
+  boost::system::error_code ec;
+  for (fs::directory_iterator it(outputDirectory, ec), end; !ec && (it != end); it.increment(ec)) {
+    string name = it->path().filename().string();
+    if (name.compare(0, prefix.size(), prefix) != 0)
+      continue;
+    size_t numEnd = name.find_first_not_of("0123456789", prefix.size());
+    if ((numEnd == prefix.size()) || (numEnd == string::npos)
+        || (name.compare(numEnd, suffix.size(), suffix) != 0)
+        || (name.find('.', numEnd+suffix.size()) != numEnd+suffix.size()))
+      continue;
+    frameCounter = max(frameCounter, (unsigned int)atoi(name.substr(prefix.size(), numEnd-prefix.size()).c_str()));
+  }
+}
+
+} // namespace
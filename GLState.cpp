@@ -0,0 +1,193 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Gui3DQt/GLState.hpp"
+
+#include <stddef.h>
+
+namespace Gui3DQt {
+
+static GLState *currentState = NULL;
+
+GLState::GLState(bool tracking_)
+  : tracking(tracking_)
+{
+  invalidate();
+}
+
+GLState& GLState::current()
+{
+  static GLState passThrough(false);
+  return currentState ? *currentState : passThrough;
+}
+
+void GLState::setCurrent(GLState *state)
+{
+  currentState = state;
+}
+
+void GLState::invalidate()
+{
+  caps.clear();
+  depthMaskKnown = false;
+  blendFuncKnown = false;
+  clearColorKnown = false;
+  viewportKnown = false;
+  cameraKnown = false;
+}
+
+bool GLState::isEnabled(GLenum cap)
+{
+  if (!tracking)
+    return glIsEnabled(cap);
+  std::map<GLenum, bool>::const_iterator c = caps.find(cap);
+  if (c != caps.end())
+    return c->second;
+  return caps[cap] = glIsEnabled(cap);
+}
+
+void GLState::set(GLenum cap, bool enabled)
+{
+  if (tracking) {
+    std::map<GLenum, bool>::iterator c = caps.find(cap);
+    if ((c != caps.end()) && (c->second == enabled))
+      return;
+    caps[cap] = enabled;
+  }
+  if (enabled)
+    glEnable(cap);
+  else
+    glDisable(cap);
+}
+
+void GLState::enable(GLenum cap)
+{
+  set(cap, true);
+}
+
+void GLState::disable(GLenum cap)
+{
+  set(cap, false);
+}
+
+void GLState::depthMask(bool enabled)
+{
+  if (tracking) {
+    if (depthMaskKnown && (depthMaskValue == enabled))
+      return;
+    depthMaskKnown = true;
+    depthMaskValue = enabled;
+  }
+  glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void GLState::blendFunc(GLenum sfactor, GLenum dfactor)
+{
+  if (tracking) {
+    if (blendFuncKnown && (blendSrc == sfactor) && (blendDst == dfactor))
+      return;
+    blendFuncKnown = true;
+    blendSrc = sfactor;
+    blendDst = dfactor;
+  }
+  glBlendFunc(sfactor, dfactor);
+}
+
+void GLState::clearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+  if (tracking) {
+    if (clearColorKnown && (clearColorValue[0] == r) && (clearColorValue[1] == g) && (clearColorValue[2] == b) && (clearColorValue[3] == a))
+      return;
+    clearColorKnown = true;
+    clearColorValue[0] = r;
+    clearColorValue[1] = g;
+    clearColorValue[2] = b;
+    clearColorValue[3] = a;
+  }
+  glClearColor(r, g, b, a);
+}
+
+void GLState::getClearColor(GLfloat *rgba)
+{
+  if (!tracking || !clearColorKnown) {
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColorValue);
+    clearColorKnown = tracking;
+  }
+  for (int i=0; i<4; ++i)
+    rgba[i] = clearColorValue[i];
+}
+
+void GLState::viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+  if (tracking) {
+    if (viewportKnown && (viewportValue[0] == x) && (viewportValue[1] == y) && (viewportValue[2] == width) && (viewportValue[3] == height))
+      return;
+    viewportKnown = true;
+    viewportValue[0] = x;
+    viewportValue[1] = y;
+    viewportValue[2] = width;
+    viewportValue[3] = height;
+  }
+  glViewport(x, y, width, height);
+}
+
+void GLState::getViewport(GLint *xywh)
+{
+  if (!tracking || !viewportKnown) {
+    glGetIntegerv(GL_VIEWPORT, viewportValue);
+    viewportKnown = tracking;
+  }
+  for (int i=0; i<4; ++i)
+    xywh[i] = viewportValue[i];
+}
+
+void GLState::setCamera(const GLdouble *view, const GLdouble *projection)
+{
+  if (!tracking)
+    return;
+  cameraKnown = true;
+  for (int i=0; i<16; ++i) {
+    viewMatrix[i] = view[i];
+    projectionMatrix[i] = projection[i];
+  }
+}
+
+void GLState::getViewMatrix(GLdouble *m)
+{
+  if (!cameraKnown) { // not cached, the modelview matrix changes while painting
+    glGetDoublev(GL_MODELVIEW_MATRIX, m);
+    return;
+  }
+  for (int i=0; i<16; ++i)
+    m[i] = viewMatrix[i];
+}
+
+void GLState::getProjectionMatrix(GLdouble *m)
+{
+  if (!cameraKnown) {
+    glGetDoublev(GL_PROJECTION_MATRIX, m);
+    return;
+  }
+  for (int i=0; i<16; ++i)
+    m[i] = projectionMatrix[i];
+}
+
+} // namespace
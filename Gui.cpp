@@ -65,6 +65,11 @@ MNavWidget* Gui::getQGlWidget()
   return mainWin->getMNavWidget();
 }
 
+ImageStream* Gui::get2DImageStream()
+{
+  return mainWin->get2DImageStream();
+}
+
 MainWindow* Gui::getMainWindow()
 {
   return mainWin;
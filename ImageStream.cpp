@@ -0,0 +1,85 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Gui3DQt/ImageStream.hpp"
+
+#include <string.h>
+#include <algorithm>
+#include <QMetaObject>
+
+using namespace std;
+
+namespace Gui3DQt {
+
+ImageStream::ImageStream(QObject *parent)
+  : QObject(parent)
+  , notificationPending(false)
+  , published(0)
+  , delivered(0)
+{
+}
+
+ImageStream::~ImageStream()
+{
+}
+
+QImage& ImageStream::frameBuffer(int width, int height, QImage::Format format)
+{
+  QImage &buf = frames.writeBuffer();
+  if ((buf.width() != width) || (buf.height() != height) || (buf.format() != format))
+    buf = QImage(width, height, format);
+  return buf;
+}
+
+void ImageStream::publish()
+{
+  frames.publish();
+  ++published;
+  if (!notificationPending.exchange(true)) // coalesce: GUI will pick the newest frame anyway
+    QMetaObject::invokeMethod(this, "deliver", Qt::QueuedConnection);
+}
+
+void ImageStream::publish(const QImage &img)
+{
+  QImage &buf = frameBuffer(img.width(), img.height(), img.format());
+  const int lineBytes = min(buf.bytesPerLine(), img.bytesPerLine());
+  for (int y=0; y<img.height(); ++y)
+    memcpy(buf.scanLine(y), img.constScanLine(y), lineBytes);
+  if (img.colorCount() > 0)
+    buf.setColorTable(img.colorTable());
+  publish();
+}
+
+unsigned int ImageStream::droppedFrames() const
+{
+  return published - delivered;
+}
+
+void ImageStream::deliver()
+{
+  notificationPending = false;
+  if (!frames.update())
+    return;
+  ++delivered;
+  emit frameReady(frames.readBuffer());
+}
+
+} // namespace
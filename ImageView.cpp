@@ -0,0 +1,409 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Gui3DQt/ImageView.hpp"
+
+#include <list>
+#include <algorithm>
+#include <math.h>
+#include <iostream>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QVector2D>
+#include <QtOpenGL/QGLShaderProgram>
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#define WHEEL_ZOOM_FACTOR     1.2
+#define NEAREST_FILTER_ZOOM   2.0 // from this zoom on, single pixels are shown as blocks
+
+using namespace std;
+
+namespace Gui3DQt {
+
+// converts the raw texture value to RGB: 0 = gray, 1 = bayer, 2 = depth with jet colormap
+static const char *rawFragmentShader =
+  "uniform sampler2D tex;\n"
+  "uniform int mode;\n"
+  "uniform vec2 size;\n"
+  "uniform vec2 redOffset;\n"
+  "uniform float scale;\n"
+  "uniform float offset;\n"
+  "float px(vec2 p, float dx, float dy) { return texture2D(tex, (p + vec2(dx, dy) + 0.5) / size).r; }\n"
+  "void main() {\n"
+  "  vec2 p = floor(gl_TexCoord[0].xy * size);\n"
+  "  float c = px(p, 0.0, 0.0);\n"
+  "  vec3 rgb;\n"
+  "  if (mode == 1) {\n" // bilinear demosaicing
+  "    vec2 parity = mod(p + redOffset, 2.0);\n"
+  "    float crossAvg = 0.25*(px(p,-1.0,0.0) + px(p,1.0,0.0) + px(p,0.0,-1.0) + px(p,0.0,1.0));\n"
+  "    float diagAvg = 0.25*(px(p,-1.0,-1.0) + px(p,1.0,-1.0) + px(p,-1.0,1.0) + px(p,1.0,1.0));\n"
+  "    float horizAvg = 0.5*(px(p,-1.0,0.0) + px(p,1.0,0.0));\n"
+  "    float vertAvg = 0.5*(px(p,0.0,-1.0) + px(p,0.0,1.0));\n"
+  "    if (parity.x < 0.5 && parity.y < 0.5) rgb = vec3(c, crossAvg, diagAvg);\n" // red
+  "    else if (parity.x > 0.5 && parity.y > 0.5) rgb = vec3(diagAvg, crossAvg, c);\n" // blue
+  "    else if (parity.y < 0.5) rgb = vec3(horizAvg, c, vertAvg);\n" // green in red row
+  "    else rgb = vec3(vertAvg, c, horizAvg);\n" // green in blue row
+  "    rgb = rgb*scale + offset;\n"
+  "  } else if (mode == 2) {\n"
+  "    float v = clamp(c*scale + offset, 0.0, 1.0);\n"
+  "    rgb = clamp(vec3(1.5 - abs(4.0*v - 3.0), 1.5 - abs(4.0*v - 2.0), 1.5 - abs(4.0*v - 1.0)), 0.0, 1.0);\n"
+  "    if (!(c > 0.0)) rgb = vec3(0.0);\n" // invalid depth, true for NaN as well
+  "  } else {\n"
+  "    rgb = vec3(c*scale + offset);\n"
+  "  }\n"
+  "  gl_FragColor = vec4(rgb, 1.0);\n"
+  "}\n";
+
+/*!
+  \class ImageTexture
+  \brief Texture holding the image of one or several ImageViews
+
+  Must be accessed in a GL context of one of its views (the contexts are shared).
+*/
+class ImageTexture
+{
+public:
+  ImageTexture() : id(0), format(0), type(0), internalFormat(0), program(NULL), programFailed(false), raw(false) {};
+  ~ImageTexture() { // GL context must be current
+    if (id != 0) glDeleteTextures(1, &id);
+    delete program;
+  };
+
+  void setImage(const QImage &img) {
+    pending = img; // implicitly shared, no pixel copy
+    pendingRaw = RawImage();
+    setSize(img.size());
+  };
+  void setImage(const RawImage &img) {
+    pendingRaw = img; // shared, no pixel copy
+    pending = QImage();
+    setSize(QSize(img.width, img.height));
+  };
+  bool bind(); // uploads a pending image and binds the texture (and shader), returns false if there is nothing to display
+  void release(); // unbinds the shader
+
+  list<ImageView*> views;
+  QSize            size;
+  bool             exactSampling() const {return raw;}; // texels must not be interpolated
+
+private:
+  QImage           pending; // not uploaded yet
+  RawImage         pendingRaw; // not uploaded yet
+  GLuint           id;
+  QSize            texSize;
+  GLenum           format;
+  GLenum           type;
+  GLint            internalFormat;
+  QGLShaderProgram *program;
+  bool             programFailed; // shaders not supported, raw images are converted on the CPU
+  bool             raw; // texture holds raw values
+  RawImage         rawParams; // format and range of the raw texture, no data
+
+  void setSize(const QSize &s) {
+    size = s;
+    for (list<ImageView*>::iterator v=views.begin(); v!=views.end(); ++v)
+      (*v)->update();
+  };
+  void upload(const void *pixels, int width, int height, int rowLength, int alignment, GLenum fmt, GLenum typ, GLint internal);
+  void uploadImage(QImage img);
+  void uploadRaw(const RawImage &img);
+  bool createProgram();
+};
+
+void ImageTexture::upload(const void *pixels, int width, int height, int rowLength, int alignment, GLenum fmt, GLenum typ, GLint internal)
+{
+  if (id == 0)
+    glGenTextures(1, &id);
+  glBindTexture(GL_TEXTURE_2D, id);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, rowLength);
+  if ((texSize == QSize(width, height)) && (format == fmt) && (type == typ) && (internalFormat == internal)) {
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, fmt, typ, pixels); // no reallocation
+  } else {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal, width, height, 0, fmt, typ, pixels);
+    texSize = QSize(width, height);
+    format = fmt;
+    type = typ;
+    internalFormat = internal;
+  }
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+void ImageTexture::uploadImage(QImage img)
+{
+  GLenum fmt, typ;
+  GLint internal;
+  switch (img.format()) {
+    case QImage::Format_RGB32:
+      fmt = GL_BGRA; typ = GL_UNSIGNED_INT_8_8_8_8_REV; internal = GL_RGB8; break; // 0xffRRGGBB on any endianness
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+      fmt = GL_BGRA; typ = GL_UNSIGNED_INT_8_8_8_8_REV; internal = GL_RGBA8; break;
+    case QImage::Format_RGB888:
+      fmt = GL_RGB; typ = GL_UNSIGNED_BYTE; internal = GL_RGB8; break;
+    case QImage::Format_RGB16:
+      fmt = GL_RGB; typ = GL_UNSIGNED_SHORT_5_6_5; internal = GL_RGB8; break;
+#if QT_VERSION >= 0x050500
+    case QImage::Format_Grayscale8:
+      fmt = GL_LUMINANCE; typ = GL_UNSIGNED_BYTE; internal = GL_LUMINANCE8; break;
+#endif
+    default: // indexed etc: needs conversion on the CPU
+      img = img.convertToFormat(QImage::Format_RGB32);
+      fmt = GL_BGRA; typ = GL_UNSIGNED_INT_8_8_8_8_REV; internal = GL_RGB8;
+  }
+  upload(img.constBits(), img.width(), img.height(), 0, 4, fmt, typ, internal); // QImage scanlines are 32bit aligned
+  raw = false;
+}
+
+void ImageTexture::uploadRaw(const RawImage &img)
+{
+  if (!createProgram()) {
+    uploadImage(img.toQImage());
+    return;
+  }
+  GLenum typ = GL_UNSIGNED_BYTE;
+  GLint internal = GL_LUMINANCE8;
+  if (img.format == RawImage::PF_Gray16) {
+    typ = GL_UNSIGNED_SHORT;
+    internal = GL_LUMINANCE16;
+  } else if (img.format == RawImage::PF_Depth32F) {
+    typ = GL_FLOAT;
+    internal = GL_LUMINANCE32F_ARB; // unclamped
+  }
+  upload(img.data.get(), img.width, img.height, img.stride/img.bytesPerPixel(), 1, GL_LUMINANCE, typ, internal);
+  raw = true;
+  rawParams = img;
+  rawParams.data.reset(); // do not keep the pixels alive
+}
+
+bool ImageTexture::createProgram()
+{
+  if (program || programFailed)
+    return !programFailed;
+  program = new QGLShaderProgram();
+  if (!QGLShaderProgram::hasOpenGLShaderPrograms()
+      || !program->addShaderFromSourceCode(QGLShader::Fragment, rawFragmentShader)
+      || !program->link()) {
+    cerr << "ImageView: raw image shader not available, converting on the CPU" << endl << program->log().toStdString() << endl;
+    delete program;
+    program = NULL;
+    programFailed = true;
+  }
+  return !programFailed;
+}
+
+bool ImageTexture::bind()
+{
+  if (!pending.isNull()) {
+    uploadImage(pending);
+    pending = QImage(); // release the reference, the caller may reuse the buffer
+  }
+  if (!pendingRaw.isNull()) {
+    uploadRaw(pendingRaw);
+    pendingRaw = RawImage();
+  }
+  if ((id == 0) || texSize.isEmpty())
+    return false;
+  glBindTexture(GL_TEXTURE_2D, id);
+  if (raw) {
+    // texture values are normalized to 0..1 for integer formats
+    float maxValue = (rawParams.format == RawImage::PF_Depth32F) ? 1.0f : ((rawParams.format == RawImage::PF_Gray16) ? 65535.0f : 255.0f);
+    float range = (rawParams.rangeMax > rawParams.rangeMin) ? (rawParams.rangeMax - rawParams.rangeMin) : maxValue;
+    int redX = ((rawParams.format == RawImage::PF_BayerGRBG8) || (rawParams.format == RawImage::PF_BayerBGGR8)) ? 1 : 0;
+    int redY = ((rawParams.format == RawImage::PF_BayerGBRG8) || (rawParams.format == RawImage::PF_BayerBGGR8)) ? 1 : 0;
+    program->bind();
+    program->setUniformValue("tex", 0);
+    program->setUniformValue("mode", rawParams.isBayer() ? 1 : ((rawParams.format == RawImage::PF_Depth32F) ? 2 : 0));
+    program->setUniformValue("size", QVector2D(texSize.width(), texSize.height()));
+    program->setUniformValue("redOffset", QVector2D(redX, redY)); // makes the red pixel even/even
+    program->setUniformValue("scale", maxValue/range);
+    program->setUniformValue("offset", -rawParams.rangeMin/range);
+  }
+  return true;
+}
+
+void ImageTexture::release()
+{
+  if (raw && program)
+    program->release();
+}
+
+
+ImageView::ImageView(QWidget *parent, const QGLWidget *shareWidget)
+  : QGLWidget(parent, shareWidget)
+  , texture(new ImageTexture())
+  , fitToWindow(false)
+  , zoomFactor(1.0)
+  , offset(0,0)
+{
+  texture->views.push_back(this);
+  setSizePolicy(QSizePolicy::Expanding,QSizePolicy::Expanding);
+}
+
+ImageView::~ImageView()
+{
+  makeCurrent(); // texture might get deleted
+  texture->views.remove(this);
+  texture.reset();
+}
+
+QSize ImageView::minimumSizeHint() const
+{
+  return QSize(50, 50);
+}
+
+QSize ImageView::sizeHint() const
+{
+  return texture->size.isEmpty() ? QSize(400, 300) : texture->size;
+}
+
+void ImageView::setImage(const QImage &img)
+{
+  texture->setImage(img);
+}
+
+void ImageView::setImage(const RawImage &img)
+{
+  texture->setImage(img);
+}
+
+bool ImageView::shareImage(ImageView &other)
+{
+  if ((&other == this) || !QGLContext::areSharing(context(), other.context()))
+    return false;
+  makeCurrent(); // own texture might get deleted
+  texture->views.remove(this);
+  texture = other.texture;
+  texture->views.push_back(this);
+  update();
+  return true;
+}
+
+QSize ImageView::imageSize() const
+{
+  return texture->size;
+}
+
+void ImageView::setFitToWindow(bool fit)
+{
+  fitToWindow = fit;
+  update();
+}
+
+void ImageView::zoom(double factor)
+{
+  QPointF center(width()/2.0, height()/2.0);
+  QPointF imgCenter = offset + center/zoomFactor;
+  zoomFactor *= factor;
+  offset = imgCenter - center/zoomFactor;
+  update();
+}
+
+void ImageView::resetView()
+{
+  zoomFactor = 1.0;
+  offset = QPointF(0,0);
+  update();
+}
+
+void ImageView::initializeGL()
+{
+  qglClearColor(palette().color(QPalette::Window));
+  glDisable(GL_DEPTH_TEST);
+  glDisable(GL_LIGHTING);
+}
+
+void ImageView::resizeGL(int width, int height)
+{
+  glViewport(0, 0, width, height);
+}
+
+void ImageView::paintGL()
+{
+  glClear(GL_COLOR_BUFFER_BIT);
+  if (!texture->bind())
+    return;
+
+  // screen rectangle of the image
+  QSize imgSize = texture->size;
+  double scale = zoomFactor;
+  QPointF topLeft = -offset*zoomFactor;
+  if (fitToWindow) {
+    scale = min((double)width()/imgSize.width(), (double)height()/imgSize.height());
+    topLeft = QPointF((width()-scale*imgSize.width())/2.0, (height()-scale*imgSize.height())/2.0);
+  }
+  QPointF bottomRight = topLeft + QPointF(scale*imgSize.width(), scale*imgSize.height());
+
+  glMatrixMode(GL_PROJECTION);
+  glLoadIdentity();
+  glOrtho(0, width(), height(), 0, -1, 1); // pixel coordinates, y pointing downwards like the image rows
+  glMatrixMode(GL_MODELVIEW);
+  glLoadIdentity();
+
+  GLint filter = ((scale >= NEAREST_FILTER_ZOOM) || texture->exactSampling()) ? GL_NEAREST : GL_LINEAR;
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture->exactSampling() ? GL_NEAREST : GL_LINEAR);
+  glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+  glEnable(GL_TEXTURE_2D);
+  glBegin(GL_QUADS);
+  glTexCoord2f(0, 0); glVertex2f(topLeft.x(), topLeft.y());
+  glTexCoord2f(1, 0); glVertex2f(bottomRight.x(), topLeft.y());
+  glTexCoord2f(1, 1); glVertex2f(bottomRight.x(), bottomRight.y());
+  glTexCoord2f(0, 1); glVertex2f(topLeft.x(), bottomRight.y());
+  glEnd();
+  texture->release();
+  glDisable(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void ImageView::mousePressEvent(QMouseEvent *event)
+{
+  event->accept();
+  lastMouse = event->pos();
+}
+
+void ImageView::mouseMoveEvent(QMouseEvent *event)
+{
+  event->accept();
+  if (fitToWindow || !(event->buttons() & Qt::LeftButton))
+    return;
+  QPoint delta = event->pos() - lastMouse;
+  lastMouse = event->pos();
+  offset -= QPointF(delta)/zoomFactor;
+  update();
+}
+
+void ImageView::wheelEvent(QWheelEvent *event)
+{
+  event->accept();
+  if (fitToWindow)
+    return;
+  double factor = pow(WHEEL_ZOOM_FACTOR, event->angleDelta().y()/120.0);
+  QPointF imgPos = offset + QPointF(event->pos())/zoomFactor; // keep image position below the mouse
+  zoomFactor *= factor;
+  offset = imgPos - QPointF(event->pos())/zoomFactor;
+  update();
+}
+
+} // namespace
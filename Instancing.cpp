@@ -0,0 +1,60 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Instancing.hpp"
+
+#include <QtOpenGL/QGLContext>
+#include <QtOpenGL/QGLShaderProgram>
+
+namespace Gui3DQt {
+namespace Instancing {
+
+bool resolve(DrawArraysInstancedFunc &drawArraysInstanced, VertexAttribDivisorFunc &vertexAttribDivisor)
+{
+  drawArraysInstanced = NULL;
+  vertexAttribDivisor = NULL;
+  const QGLContext *context = QGLContext::currentContext();
+  if (!context || !QGLShaderProgram::hasOpenGLShaderPrograms())
+    return false;
+  drawArraysInstanced = (DrawArraysInstancedFunc)context->getProcAddress("glDrawArraysInstanced");
+  if (!drawArraysInstanced)
+    drawArraysInstanced = (DrawArraysInstancedFunc)context->getProcAddress("glDrawArraysInstancedARB");
+  vertexAttribDivisor = (VertexAttribDivisorFunc)context->getProcAddress("glVertexAttribDivisor");
+  if (!vertexAttribDivisor)
+    vertexAttribDivisor = (VertexAttribDivisorFunc)context->getProcAddress("glVertexAttribDivisorARB");
+  return drawArraysInstanced && vertexAttribDivisor;
+}
+
+bool resolve(DrawElementsInstancedFunc &drawElementsInstanced, VertexAttribDivisorFunc &vertexAttribDivisor)
+{
+  DrawArraysInstancedFunc drawArraysInstanced;
+  drawElementsInstanced = NULL;
+  if (!resolve(drawArraysInstanced, vertexAttribDivisor))
+    return false;
+  const QGLContext *context = QGLContext::currentContext();
+  drawElementsInstanced = (DrawElementsInstancedFunc)context->getProcAddress("glDrawElementsInstanced");
+  if (!drawElementsInstanced)
+    drawElementsInstanced = (DrawElementsInstancedFunc)context->getProcAddress("glDrawElementsInstancedARB");
+  return drawElementsInstanced != NULL;
+}
+
+}
+}
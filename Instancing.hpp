@@ -0,0 +1,58 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   Instancing.hpp
+ *  \brief  Resolves the entry points for instanced drawing
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_INSTANCING_HPP_
+#define GUI3DQT_INSTANCING_HPP_
+
+#include <stddef.h>
+#include <GL/gl.h>
+
+namespace Gui3DQt {
+namespace Instancing {
+
+  typedef void (APIENTRY *DrawArraysInstancedFunc)(GLenum, GLint, GLsizei, GLsizei);
+  typedef void (APIENTRY *VertexAttribDivisorFunc)(GLuint, GLuint);
+  typedef void (APIENTRY *DrawElementsInstancedFunc)(GLenum, GLsizei, GLenum, const GLvoid*, GLsizei);
+
+  //! entry points of a context, the public classes only hold a pointer so the signatures stay in this header
+  struct Functions {
+    Functions() : drawArraysInstanced(NULL), drawElementsInstanced(NULL), vertexAttribDivisor(NULL) {}
+    DrawArraysInstancedFunc   drawArraysInstanced;
+    DrawElementsInstancedFunc drawElementsInstanced;
+    VertexAttribDivisorFunc   vertexAttribDivisor;
+  };
+
+  /*! Looks up glDrawArraysInstanced and glVertexAttribDivisor (core or ARB) in the current context
+   *  and checks for shader support.
+   *  \return false if instanced drawing is not available, the caller then has to draw instance by instance
+   */
+  bool resolve(DrawArraysInstancedFunc &drawArraysInstanced, VertexAttribDivisorFunc &vertexAttribDivisor);
+
+  //! same for glDrawElementsInstanced, used by indexed meshes
+  bool resolve(DrawElementsInstancedFunc &drawElementsInstanced, VertexAttribDivisorFunc &vertexAttribDivisor);
+
+}
+}
+
+#endif // GUI3DQT_INSTANCING_HPP_
@@ -25,7 +25,9 @@
 //#include <QtOpenGL>
 #include <QSizePolicy>
 #include <math.h>
+#include <string.h>
 #include <iostream>
+#include <algorithm>
 #include <GL/glu.h>
 
 #include "Gui3DQt/graphics.hpp"
@@ -46,6 +48,8 @@
 #define KEY_MOVE_AMOUNT   10.0
 #define KEY_ZOOM_AMOUNT   5.0
 
+#define DEFAULT_ASYNC_GRAB_DEPTH             3
+
 
 using namespace std;
 using namespace Gui3DQt::Graphics;
@@ -88,6 +92,12 @@ MNavWidget::MNavWidget(QWidget *parent)
   zoom_sensitivity_2D = DEFAULT_ZOOM_SENSITIVITY_2D;
   rotate_sensitivity_2D = DEFAULT_ROTATE_SENSITIVITY_2D;
   move_sensitivity_2D = DEFAULT_MOVE_SENSITIVITY_2D;
+
+  grabDepth = DEFAULT_ASYNC_GRAB_DEPTH;
+  grabHead = 0;
+  grabPending = 0;
+  offscreenBuffer = NULL;
+  glInitialized = false;
 //  cout << "GLWIDGET CREATED" << endl;
   
   setFocusPolicy(Qt::StrongFocus);
@@ -95,7 +105,11 @@ MNavWidget::MNavWidget(QWidget *parent)
 
 MNavWidget::~MNavWidget()
 {
-//    makeCurrent();
+  makeCurrent();
+  destroyGrabBuffers();
+  delete offscreenBuffer;
+  if (&GLState::current() == &glState)
+    GLState::setCurrent(NULL);
 }
 
 QSize MNavWidget::minimumSizeHint() const
@@ -108,6 +122,11 @@ QSize MNavWidget::sizeHint() const
     return QSize(400, 300);
 }
 
+void MNavWidget::setUserPreparePaint(boost::function<void()> func)
+{
+  userPreparePaint = func;
+}
+
 void MNavWidget::setUserPaintGLOpaque(boost::function<void()> func)
 {
 	userPaintGLOpaque = func;
@@ -123,11 +142,16 @@ void MNavWidget::setUserAfterPaint(boost::function<void()> func)
   userAfterPaint = func;
 }
 
+void MNavWidget::setUserFrameSink(boost::function<void(const QImage&)> func)
+{
+  userFrameSink = func;
+}
+
 
 void MNavWidget::initializeGL()
 {
 //  cout << "INITIALIZE GL" << flush;
-  glEnable(GL_DEPTH_TEST);
+  GLState::setCurrent(&glState);
   //glEnable(GL_CULL_FACE); // if enabled, surfaces can be flagged to be drawn only from one side
   //glShadeModel(GL_FLAT); // a polygon as only one color
   glShadeModel(GL_SMOOTH); // a polygon might have a color gradient if its vertices have a different color assigned
@@ -140,16 +164,80 @@ void MNavWidget::initializeGL()
   glLightfv(GL_LIGHT0, GL_DIFFUSE, light_diffuse);
   glLightfv(GL_LIGHT0, GL_SPECULAR, light_specular);
   glLightfv(GL_LIGHT0, GL_POSITION, light_position);
-  glEnable(GL_LIGHT0);
-  glDisable(GL_LIGHTING); // by default, disable lighting
-  glEnable(GL_NORMALIZE); // calls to glNormal will result in normalized normal vectors
-  glClearColor(0.0, 0.0, 0.0, 1.0); // set background color (red,gree,blue,alpha): black
+  setDefaultState();
+  glState.clearColor(0.0, 0.0, 0.0, 1.0); // set background color (red,gree,blue,alpha): black
   glClearDepth(1.0); // set maximum depth
+  glInitialized = true;
+  GLState::setCurrent(NULL); // other contexts must not change this cache
 //  cout << "...done" << endl;
 }
 
+void MNavWidget::setDefaultState()
+{
+  glState.invalidate(); // values left by direct state changes are unknown, each call below goes to the driver
+  glState.enable(GL_DEPTH_TEST);
+  glState.enable(GL_LIGHT0);
+  glState.disable(GL_LIGHTING); // by default, disable lighting
+  glState.enable(GL_NORMALIZE); // calls to glNormal will result in normalized normal vectors
+  glState.disable(GL_BLEND);
+  glState.depthMask(true);
+}
+
 void MNavWidget::paintGL()
 {
+  renderScene(width(), height());
+  glFlush();
+  
+  if (userAfterPaint)
+    userAfterPaint();
+}
+
+bool MNavWidget::renderOffscreen(QImage &frame, int w, int h)
+{
+  if (w <= 0) w = width();
+  if (h <= 0) h = height();
+  if (!isValid() || (w <= 0) || (h <= 0))
+    return false;
+  makeCurrent();
+  if (!glInitialized) // widget was never shown, e.g. in batch mode
+    glInit();
+  if ((offscreenBuffer != NULL) && (offscreenBuffer->size() != QSize(w,h))) {
+    delete offscreenBuffer;
+    offscreenBuffer = NULL;
+  }
+  if (offscreenBuffer == NULL)
+    offscreenBuffer = new QGLFramebufferObject(w, h, QGLFramebufferObject::Depth);
+  if (!offscreenBuffer->isValid() || !offscreenBuffer->bind())
+    return false;
+  renderScene(w, h);
+  offscreenBuffer->release();
+  frame = offscreenBuffer->toImage().convertToFormat(QImage::Format_RGB32); // drop alpha as grabFrameBuffer() does
+  return true;
+}
+
+bool MNavWidget::renderFrameToSink()
+{
+  QImage frame;
+  if (!renderOffscreen(frame))
+    return false;
+  if (userFrameSink)
+    userFrameSink(frame);
+  return true;
+}
+
+void MNavWidget::endFrameSequence()
+{
+  if (userFrameSink)
+    userFrameSink(QImage());
+}
+
+void MNavWidget::renderScene(int width, int height)
+{
+  GLState::setCurrent(&glState);
+  setDefaultState();
+  if (userPreparePaint)
+    userPreparePaint();
+
 	/* setup camera view */
   if(gui_mode == GUI_MODE_3D) {
 	  float cpan, ctilt, camera_x, camera_y, camera_z;
@@ -158,45 +246,53 @@ void MNavWidget::paintGL()
 	  camera_x = cam_distance * cos(cpan) * cos(ctilt);
 	  camera_y = cam_distance * sin(cpan) * cos(ctilt);
 	  camera_z = cam_distance * sin(ctilt);
-    set_display_mode_3D(width(), height(), camera_fov, min_clip_range, max_clip_range);
-	  glViewport(0, 0, (GLsizei)width(), (GLsizei)height());
+    set_display_mode_3D(width, height, camera_fov, min_clip_range, max_clip_range);
+	  glState.viewport(0, 0, (GLsizei)width, (GLsizei)height);
 	  gluLookAt(camera_x + cam_x_offset, camera_y + cam_y_offset, camera_z + cam_z_offset, cam_x_offset, cam_y_offset, cam_z_offset, 0, 0, 1);
   }
   else if(gui_mode == GUI_MODE_2D)  {
-    set_display_mode_2D(width(), height());
-    glTranslatef(width() / 2.0, height() / 2.0, 0.0);
+    set_display_mode_2D(width, height);
+    glState.viewport(0, 0, (GLsizei)width, (GLsizei)height);
+    glTranslatef(width / 2.0, height / 2.0, 0.0);
     glScalef(cam_zoom, cam_zoom, 1.0);
     glRotatef(radians_to_degrees(cam_rotation_2D), 0, 0, 1);
     glScalef(cam_warp_x, cam_warp_y, 1);
     glTranslatef(-cam_x_offset_2D, -cam_y_offset_2D, 0.0);
   }
 
+  // publish the camera once, paint functions read it from the state cache
+  GLdouble view[16], projection[16];
+  glGetDoublev(GL_MODELVIEW_MATRIX, view);
+  glGetDoublev(GL_PROJECTION_MATRIX, projection);
+  glState.setCamera(view, projection);
+
   /* clear window */
-  glDepthMask(true);
+  glState.depthMask(true);
 //  glClear(GL_COLOR_BUFFER_BIT | GL_ACCUM_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); 
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); 
 
   // draw first all opaque(non-transparent) objects with depth buffer writable
-  glDisable(GL_BLEND); // disable transparency effects
+  glState.disable(GL_BLEND); // disable transparency effects
   if (userPaintGLOpaque)
     userPaintGLOpaque();
 
   // then make the depth buffer read-only (i.e. depth-buffer is determined by opal objects only),
   // draw all translucent object in any order,
   // finally make the depth buffer writable again
-  glDepthMask(false);
-  glEnable(GL_BLEND); // enable transparent effects
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glState.depthMask(false);
+  glState.enable(GL_BLEND); // enable transparent effects
+  glState.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 //  glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA);
 //  glBlendFunc(GL_DST_COLOR, GL_SRC_ALPHA); //SRC-factor : existing pixels, DST-factor: about to draw 
   if (userPaintGLTranslucent)
 		userPaintGLTranslucent();
-  glDepthMask(true);
+  glState.depthMask(true);
+  GLState::setCurrent(NULL); // other contexts must not change this cache
+}
 
-  glFlush();
-  
-  if (userAfterPaint)
-    userAfterPaint();
+GLState& MNavWidget::getGLState()
+{
+  return glState;
 }
 
 void MNavWidget::resizeGL(int width, int height)
@@ -466,6 +562,96 @@ void MNavWidget::get_2D_position(int x, int y, double *xout, double *yout)
   *yout = cam_y_offset_2D + stheta * dx + ctheta * dy;
 }
 
+void MNavWidget::setAsyncGrabDepth(unsigned int nbFrames)
+{
+  makeCurrent();
+  destroyGrabBuffers(); // pending frames are dropped
+  grabDepth = max(2u, nbFrames);
+}
+
+bool MNavWidget::grabFrameBufferAsync(QImage &frame)
+{
+  if (grabBuffers.empty() && !createGrabBuffers()) { // pixel buffer objects not supported -> synchronous fallback
+    frame = grabFrameBuffer();
+    return true;
+  }
+  QSize size(width(), height());
+  QGLBuffer *pbo = grabBuffers[grabHead];
+  pbo->bind();
+  if (grabSizes[grabHead] != size) {
+    pbo->allocate(size.width()*size.height()*4);
+    grabSizes[grabHead] = size;
+  }
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glReadPixels(0, 0, size.width(), size.height(), GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, 0); // returns immediately, transfer into the buffer happens asynchronously
+  pbo->release();
+  grabHead = (grabHead+1) % grabBuffers.size();
+  ++grabPending;
+  // the oldest frame was queued grabDepth-1 paints ago and is most likely transferred by now
+  if (grabPending == grabBuffers.size())
+    return readGrabBuffer(frame);
+  return false;
+}
+
+bool MNavWidget::finishFrameBufferAsync(QImage &frame)
+{
+  if (grabPending == 0)
+    return false;
+  makeCurrent();
+  while (grabPending > 0) {
+    if (readGrabBuffer(frame))
+      return true;
+  }
+  return false;
+}
+
+bool MNavWidget::createGrabBuffers()
+{
+  for (unsigned int i=0; i<grabDepth; ++i) {
+    QGLBuffer *pbo = new QGLBuffer(QGLBuffer::PixelPackBuffer);
+    pbo->setUsagePattern(QGLBuffer::StreamRead);
+    if (!pbo->create()) {
+      delete pbo;
+      destroyGrabBuffers();
+      return false;
+    }
+    grabBuffers.push_back(pbo);
+    grabSizes.push_back(QSize());
+  }
+  grabHead = 0;
+  grabPending = 0;
+  return true;
+}
+
+void MNavWidget::destroyGrabBuffers()
+{
+  for (unsigned int i=0; i<grabBuffers.size(); ++i)
+    delete grabBuffers[i]; // releases the OpenGL buffer
+  grabBuffers.clear();
+  grabSizes.clear();
+  grabHead = 0;
+  grabPending = 0;
+}
+
+bool MNavWidget::readGrabBuffer(QImage &frame)
+{
+  unsigned int idx = (grabHead + grabBuffers.size() - grabPending) % grabBuffers.size();
+  --grabPending;
+  QSize size = grabSizes[idx];
+  QGLBuffer *pbo = grabBuffers[idx];
+  pbo->bind();
+  const uchar *data = static_cast<const uchar*>(pbo->map(QGLBuffer::ReadOnly));
+  if (data != NULL) {
+    frame = QImage(size, QImage::Format_RGB32);
+    const int lineBytes = size.width()*4;
+    for (int y=0; y<size.height(); ++y) // OpenGL stores rows bottom-up
+      memcpy(frame.scanLine(y), data + (size.height()-1-y)*lineBytes, lineBytes);
+    pbo->unmap();
+  }
+  pbo->release();
+  return (data != NULL);
+}
+
 void MNavWidget::rotate_camera(double dx, double dy)
 {
   cam_pan -= dx * rotate_sensitivity;
@@ -25,11 +25,10 @@
 #include <GL/glut.h>
 #include <QInputDialog>
 #include <QFileDialog>
+#include <QActionGroup>
 #include <QVBoxLayout>
 #include <QDesktopWidget>
 #include <boost/filesystem.hpp>
-#include <boost/algorithm/string/replace.hpp>
-#include <boost/format.hpp>
 #include <boost/bind.hpp>
 
 #include "Gui3DQt/MNavWidget.hpp"
@@ -51,14 +50,13 @@ namespace Gui3DQt {
 MainWindow::MainWindow(GuiMode gMode, QWidget *parent)
   : QMainWindow(parent)
     ,guiMode(gMode)
-    ,image2D(0,0, QImage::Format_RGB16)
     ,addedWidgets(0)
-    ,currImgScaleFactor(1.0)
     ,imageOutputDirectory(QDir::homePath().toStdString())
     ,imageFilePattern("img*.png")
-    ,frameCounter(0)
+    ,frameWriter(new FrameWriter())
     ,grabFrames(false)
     ,grabSingleFrame(false)
+    ,workerPool(new WorkerPool())
 {
   // create GUI and update labelings
   ui = new Ui::MainWindowClass();
@@ -88,6 +86,17 @@ MainWindow::MainWindow(GuiMode gMode, QWidget *parent)
   ui->tab3D->setLayout(glLayout);
   glWid = new MNavWidget();
   glLayout->addWidget(glWid);
+  // setup image views, sharing textures with the OpenGL Widget and each other
+  imageView = new ImageView(0, glWid);
+  ui->tab2D->layout()->addWidget(imageView);
+  imagePreview = new ImageView(0, glWid);
+  imagePreview->setFitToWindow(true);
+  ui->sd->layout()->addWidget(imagePreview);
+  previewSharesImage = imagePreview->shareImage(*imageView);
+  qRegisterMetaType<RawImage>("Gui3DQt::RawImage"); // for queued redraw2D signals
+  imageStream = new ImageStream(this);
+  if (guiMode == GM_3D2D)
+    QObject::connect( imageStream, SIGNAL(frameReady(QImage&)), this, SLOT(set2DImage(QImage&)) );
   // connect GUI to slots in this class
   QObject::connect(ui->actionChangeView, SIGNAL(triggered()), this, SLOT(changeView2D3D()));
   QObject::connect(ui->actionShowHideControlPanel, SIGNAL(triggered()), this, SLOT(showHideControlPanel()));
@@ -99,16 +108,39 @@ MainWindow::MainWindow(GuiMode gMode, QWidget *parent)
   QObject::connect(ui->actionSetFilePattern, SIGNAL(triggered()), this, SLOT(setImageFilePattern()));
   QObject::connect(ui->actionGrab, SIGNAL(toggled(bool)), this, SLOT(startStopGrabbing(bool)));
   QObject::connect(ui->actionShot, SIGNAL(triggered()), this, SLOT(startSingleGrab()));
-
+  QActionGroup *formatGroup = new QActionGroup(this);
+  formatGroup->addAction(ui->actionFormatAuto)->setData(FrameWriter::FF_Auto);
+  formatGroup->addAction(ui->actionFormatPNG)->setData(FrameWriter::FF_PNG);
+  formatGroup->addAction(ui->actionFormatPNGFast)->setData(FrameWriter::FF_PNGFast);
+  formatGroup->addAction(ui->actionFormatBMP)->setData(FrameWriter::FF_BMP);
+  formatGroup->addAction(ui->actionFormatPPM)->setData(FrameWriter::FF_PPM);
+  QObject::connect(formatGroup, SIGNAL(triggered(QAction*)), this, SLOT(setImageFormat(QAction*)));
+  QActionGroup *policyGroup = new QActionGroup(this);
+  policyGroup->addAction(ui->actionQueueBlock)->setData(FrameWriter::QP_Block);
+  policyGroup->addAction(ui->actionQueueDropNewest)->setData(FrameWriter::QP_DropNewest);
+  policyGroup->addAction(ui->actionQueueDropOldest)->setData(FrameWriter::QP_DropOldest);
+  QObject::connect(policyGroup, SIGNAL(triggered(QAction*)), this, SLOT(setGrabQueuePolicy(QAction*)));
+  QActionGroup *sinkGroup = new QActionGroup(this);
+  sinkGroup->addAction(ui->actionSinkImages)->setData(FrameWriter::OS_Images);
+  sinkGroup->addAction(ui->actionSinkY4MFile)->setData(FrameWriter::OS_Y4MFile);
+  sinkGroup->addAction(ui->actionSinkEncoderPipe)->setData(FrameWriter::OS_EncoderPipe);
+  QObject::connect(sinkGroup, SIGNAL(triggered(QAction*)), this, SLOT(setGrabSink(QAction*)));
+  QObject::connect(ui->actionSetEncoderCommand, SIGNAL(triggered()), this, SLOT(setEncoderCommand()));
+  frameWriter->setOutput(imageOutputDirectory, imageFilePattern);
+
+  glWid->setUserPreparePaint(boost::bind( &MainWindow::preparePaint, this));
   glWid->setUserPaintGLOpaque(boost::bind( &MainWindow::paintGLOpaque, this));
   glWid->setUserPaintGLTranslucent(boost::bind( &MainWindow::paintGLTranslucent, this));
   glWid->setUserAfterPaint(boost::bind( &MainWindow::afterGLPaint, this));
+  glWid->setUserFrameSink(boost::bind( &MainWindow::saveRenderedFrame, this, _1));
   //glWid->setCameraParams(0.001, 0.3, 0.001, 0.009, 60, 1, 1000); //zoom_sensitivity, rotate_sensitivity, move_sensitivity, min_zoom_range, camera_fov, min_clip_range, max_clip_range
   glWid->setCameraPos(180.0, 89.99, 100.0, 0, 0, 0); //pan, tilt, range, x_offset, y_offset, z_offset
 }
 
 MainWindow::~MainWindow()
 {
+  delete frameWriter; // waits until all frames are stored
+  delete workerPool;
   delete ui;
 }
 
@@ -155,8 +187,10 @@ void MainWindow::registerVisualizer(Visualizer *vis, string title, VisualizerMod
   }
   controlLayout->insertWidget(controlLayout->count()-1, wAdd); // insert before spacer
   QObject::connect( vis, SIGNAL(stateChanged()), glWid, SLOT(updateGL()) );
-  if (guiMode == GM_3D2D)
+  if (guiMode == GM_3D2D) {
     QObject::connect( vis, SIGNAL(redraw2D(QImage&)), this, SLOT(set2DImage(QImage&)) );
+    QObject::connect( vis, SIGNAL(redraw2D(const Gui3DQt::RawImage&)), this, SLOT(set2DImage(const Gui3DQt::RawImage&)) );
+  }
   visualizers.push_back(VisGroupbox(vis,frame));
   vis->show();
 }
@@ -166,23 +200,28 @@ MNavWidget* MainWindow::getMNavWidget()
   return glWid;
 }
 
+ImageStream* MainWindow::get2DImageStream()
+{
+  return imageStream;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 //////////////////          private methods            ///////////////////////
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 
-string MainWindow::getCurrentOutputFilename()
+void MainWindow::preparePaint()
 {
-  fs::path fullName = fs::path("");
-  do {
-    frameCounter++;
-    string fName = imageFilePattern;
-    string number = (boost::format("%1$05d") % frameCounter).str();
-    boost::replace_first(fName, "*", number);
-    fullName = fs::path(imageOutputDirectory / fName);
-  } while (exists(fullName));
-  return fullName.string();
+  vector<WorkerPool::Job> jobs;
+  for (list<VisGroupbox>::iterator i=visualizers.begin(); i!=visualizers.end(); i++) {
+    if ((i->second == NULL) || (i->second->isChecked()))
+      jobs.push_back(boost::bind(&Visualizer::prepare, i->first));
+  }
+  if (jobs.size() == 1)
+    jobs[0](); // no need to involve other threads
+  else if (!jobs.empty())
+    workerPool->run(jobs);
 }
 
 void MainWindow::paintGLOpaque()
@@ -201,15 +240,35 @@ void MainWindow::paintGLTranslucent()
   }
 }
 
+void MainWindow::saveFrame(const QImage &frame)
+{
+  if (grabFrames)
+    frameWriter->push(frame);
+  else
+    frameWriter->pushStill(frame);
+}
+
+void MainWindow::saveRenderedFrame(const QImage &frame)
+{
+  if (frame.isNull()) // end of sequence
+    frameWriter->closeStream();
+  else
+    frameWriter->push(frame, FrameWriter::QP_Block);
+}
+
 void MainWindow::afterGLPaint()
 {
   // store frame if grabbing is active
-  if ((grabFrames || grabSingleFrame) && (ui->tabWidget->currentIndex() == 0)) {
+  if (ui->tabWidget->currentIndex() != 0)
+    return;
+  QImage frame;
+  if (grabFrames) { // asynchronous readback, returns the frame of some paints ago
+    grabSingleFrame = false;
+    if (glWid->grabFrameBufferAsync(frame))
+      saveFrame(frame);
+  } else if (grabSingleFrame) {
     grabSingleFrame = false;
-    QImage frame = glWid->grabFrameBuffer(); // bool withAlpha = false
-    string filename = getCurrentOutputFilename();
-    cout << "store frame as " << filename << endl;
-    frame.save(QString(filename.c_str()));
+    saveFrame(glWid->grabFrameBuffer()); // bool withAlpha = false
   }
 }
 
@@ -221,20 +280,6 @@ void MainWindow::updateGUI()
   //ui->actionSetFilePattern->setText(outputPattern.c_str());
 }
 
-void MainWindow::setScaledImage(float factor)
-{
-  currImgScaleFactor *= factor;
-//  ui->imgPlaceholder->resize(currImgScaleFactor * ui->imgPlaceholder->pixmap()->size());
-  ui->imgPlaceholder->setPixmap(QPixmap::fromImage(image2D.scaled(image2D.size()*currImgScaleFactor)));
-  adjustScrollBar(ui->imgScrollArea->horizontalScrollBar(), factor);
-  adjustScrollBar(ui->imgScrollArea->verticalScrollBar(), factor);
-}
-
-void MainWindow::adjustScrollBar(QScrollBar *scrollBar, double factor)
-{
-  scrollBar->setValue(int(factor * scrollBar->value() + ((factor-1) * scrollBar->pageStep()/2)));
-}
-
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 //////////////////           private slots             ///////////////////////
@@ -251,39 +296,54 @@ void MainWindow::viewChanged(int tab)
 
 void MainWindow::set2DImage(QImage& img)
 {
-  image2D = img;
-//  ui->imgPlaceholder->setPixmap(QPixmap::fromImage(img));
-  setScaledImage(1.0);
-  ui->imgPlaceholder2->setPixmap(QPixmap::fromImage(img));
+  image2D = img; // implicitly shared, no pixel copy
+  raw2D = RawImage();
+  imageView->setImage(img); // uploaded on the next paint of a visible view
+  if (!previewSharesImage)
+    imagePreview->setImage(img);
   // store frame if grabbing is active
   if (((grabFrames) || (grabSingleFrame)) && (ui->tabWidget->currentIndex() == 1)) {
     grabSingleFrame = false;
-    string filename = getCurrentOutputFilename();
-    cout << "store frame as " << filename << endl;
-    img.save(QString(filename.c_str()));
+    saveFrame(img);
+  }
+}
+
+void MainWindow::set2DImage(const RawImage& img)
+{
+  raw2D = img; // shared, no pixel copy
+  image2D = QImage();
+  imageView->setImage(img); // converted on the GPU
+  if (!previewSharesImage)
+    imagePreview->setImage(img);
+  // store frame if grabbing is active, needs conversion on the CPU
+  if (((grabFrames) || (grabSingleFrame)) && (ui->tabWidget->currentIndex() == 1)) {
+    grabSingleFrame = false;
+    saveFrame(img.toQImage());
   }
 }
 
 void MainWindow::setWhiteBackground()
 {
-	glClearColor(1.0, 1.0, 1.0, 1.0); //alpha=1.0 -> full overwrite of colors
+  glWid->makeCurrent(); // the image views have their own context
+	glWid->getGLState().clearColor(1.0, 1.0, 1.0, 1.0); //alpha=1.0 -> full overwrite of colors
   //glClear is called in QGlMNavWidget before each paint, to make the change effective 
 }
 
 void MainWindow::setBlackBackground()
 {
-	glClearColor(0.0, 0.0, 0.0, 1.0); //alpha=1.0 -> full overwrite of colors
+  glWid->makeCurrent(); // the image views have their own context
+	glWid->getGLState().clearColor(0.0, 0.0, 0.0, 1.0); //alpha=1.0 -> full overwrite of colors
   //glClear is called in QGlMNavWidget before each paint, to make the change effective 
 }
 
 void MainWindow::zoomIn2D()
 {
-  setScaledImage(IMAGE_2D_ZOOM_FACTOR);
+  imageView->zoom(IMAGE_2D_ZOOM_FACTOR);
 }
 
 void MainWindow::zoomOut2D()
 {
-  setScaledImage(1/IMAGE_2D_ZOOM_FACTOR);
+  imageView->zoom(1/IMAGE_2D_ZOOM_FACTOR);
 }
 
 void MainWindow::changeView2D3D()
@@ -304,9 +364,58 @@ void MainWindow::showHideControlPanel()
 void MainWindow::setImageOutputDir(string dir)
 {
   imageOutputDirectory = fs::path(dir);
+  frameWriter->setOutput(imageOutputDirectory, imageFilePattern);
   updateGUI();
 }
 
+void MainWindow::setImageFormat(FrameWriter::Format format)
+{
+  frameWriter->setFormat(format);
+  QList<QAction*> actions = ui->menuFileFormat->actions();
+  for (int i=0; i<actions.size(); ++i)
+    actions[i]->setChecked(actions[i]->data().toInt() == format);
+}
+
+void MainWindow::setImageFormat(QAction *action)
+{
+  setImageFormat((FrameWriter::Format)action->data().toInt());
+}
+
+void MainWindow::setGrabQueuePolicy(FrameWriter::QueuePolicy policy)
+{
+  frameWriter->setQueuePolicy(policy);
+  QList<QAction*> actions = ui->menuQueuePolicy->actions();
+  for (int i=0; i<actions.size(); ++i)
+    actions[i]->setChecked(actions[i]->data().toInt() == policy);
+}
+
+void MainWindow::setGrabQueuePolicy(QAction *action)
+{
+  setGrabQueuePolicy((FrameWriter::QueuePolicy)action->data().toInt());
+}
+
+void MainWindow::setGrabSink(FrameWriter::Sink sink)
+{
+  frameWriter->setSink(sink); // a running stream is finished, the next grabbed frame starts a new one
+  QList<QAction*> actions = ui->menuSink->actions();
+  for (int i=0; i<actions.size(); ++i)
+    actions[i]->setChecked(actions[i]->data().toInt() == sink);
+  ui->menuFileFormat->setEnabled(sink == FrameWriter::OS_Images);
+}
+
+void MainWindow::setGrabSink(QAction *action)
+{
+  setGrabSink((FrameWriter::Sink)action->data().toInt());
+}
+
+void MainWindow::setEncoderCommand()
+{
+  bool ok;
+  QString text = QInputDialog::getText(this, tr("Set Encoder Command"), tr("reads YUV4MPEG2 from stdin, %1 will be replaced by the numbered file pattern"), QLineEdit::Normal, QString(frameWriter->getEncoderCommand().c_str()), &ok);
+  if (ok && !text.isEmpty())
+    frameWriter->setEncoderCommand(text.toStdString());
+}
+
 void MainWindow::setImageOutputDir()
 {
   QFileDialog dialog(this);
@@ -322,8 +431,10 @@ void MainWindow::setImageFilePattern()
 {
   bool ok;
   QString text = QInputDialog::getText(this, tr("Set Image File Pattern"), tr("* will be replaces by numbers"), QLineEdit::Normal, QString(imageFilePattern.c_str()), &ok);
-  if (ok && !text.isEmpty())
+  if (ok && !text.isEmpty()) {
     imageFilePattern = text.toStdString();
+    frameWriter->setOutput(imageOutputDirectory, imageFilePattern);
+  }
   updateGUI();
 }
 
@@ -335,19 +446,26 @@ void MainWindow::setGrabbingActive(bool flag)
 void MainWindow::startStopGrabbing(bool grab)
 {
   grabFrames = grab;
-  if (grabFrames)
+  if (grabFrames) {
     statusBar()->showMessage(tr("Grabbing Activated"));
-  else
-    statusBar()->showMessage(tr(""));
+  } else {
+    QImage frame;
+    while (glWid->finishFrameBufferAsync(frame)) // store frames still in flight
+      frameWriter->push(frame);
+    frameWriter->closeStream(); // finishes the video stream, if any
+    unsigned int dropped = frameWriter->droppedFrames();
+    if (dropped > 0)
+      statusBar()->showMessage(tr("Grabbing dropped %1 frames").arg(dropped));
+    else
+      statusBar()->showMessage(tr(""));
+  }
 }
 
 void MainWindow::startSingleGrab()
 {
   // store immediately (otherwise the next image will be stored)
   if (ui->tabWidget->currentIndex() == 1) {
-    string filename = getCurrentOutputFilename();
-    cout << "store frame as " << filename << endl;
-    image2D.save(QString(filename.c_str()));
+    saveFrame(raw2D.isNull() ? image2D : raw2D.toQImage());
     grabSingleFrame = false;
   } else {
     grabSingleFrame = true;
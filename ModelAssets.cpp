@@ -0,0 +1,174 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Gui3DQt/ModelAssets.hpp"
+#include "Gui3DQt/WorkerPool.hpp"
+#include "models3d.hpp"
+
+#include <math.h>
+#include <stdexcept>
+#include <boost/bind.hpp>
+
+using namespace std;
+
+namespace Gui3DQt {
+
+static const GLfloat lodCellSize[ModelAssets::NB_LODS] = {0, 1./64, 1./24, 1./10}; // relative to the model extent
+static const double lodMinPixels[ModelAssets::NB_LODS-1] = {200, 60, 20}; // projected vehicle length down to which a level is used
+static const char *assetNames[ModelAssets::NB_ASSETS] = {"passat", "tire", "velodyne"};
+
+ModelAssets& ModelAssets::instance()
+{
+  static ModelAssets assets;
+  return assets;
+}
+
+int ModelAssets::levelOfDetail(double pixels)
+{
+  int lod = 0;
+  while ((lod < NB_LODS-1) && (fabs(pixels) < lodMinPixels[lod]))
+    ++lod;
+  return lod;
+}
+
+ModelAssets::ModelAssets()
+  : pool(NULL)
+{
+  for (int a=0; a<NB_ASSETS; ++a)
+    entries[a].state = NOT_PREPARED;
+}
+
+ModelAssets::~ModelAssets()
+{
+  delete pool; // waits for running preparations
+}
+
+void ModelAssets::preload(bool wait)
+{
+  WorkerPool *p;
+  {
+    boost::mutex::scoped_lock lock(mutex);
+    if (!pool)
+      pool = new WorkerPool(NB_ASSETS);
+    for (int a=0; a<NB_ASSETS; ++a) {
+      if (entries[a].state == NOT_PREPARED) {
+        entries[a].state = PREPARING;
+        pool->post(boost::bind(&ModelAssets::prepare, this, (Asset)a));
+      }
+    }
+    p = pool;
+  }
+  if (wait)
+    p->wait();
+}
+
+void ModelAssets::prepare(Asset asset)
+{
+  vector< boost::shared_ptr<IndexedModel> > lods(NB_LODS);
+  State result = READY;
+  try {
+    lods[0].reset(new IndexedModel());
+    switch (asset) {
+      case PASSAT:   generate_passat(*lods[0]); break;
+      case TIRE:     generate_tire(*lods[0]); break;
+      default:       generate_velodyne(*lods[0]); break;
+    }
+    const GLfloat extent = lods[0]->extent();
+    for (int l=1; l<NB_LODS; ++l) {
+      lods[l].reset(new IndexedModel());
+      lods[l]->simplify(*lods[0], lodCellSize[l]*extent);
+    }
+  } catch (exception &e) {
+    cerr << "ModelAssets: " << e.what() << endl;
+    lods.clear();
+    result = FAILED;
+  }
+  boost::mutex::scoped_lock lock(mutex);
+  entries[asset].lods.swap(lods);
+  entries[asset].state = result;
+  prepared.notify_all();
+}
+
+boost::shared_ptr<IndexedModel> ModelAssets::get(Asset asset, int lod)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  Entry &entry = entries[asset];
+  if (entry.state == NOT_PREPARED) {
+    entry.state = PREPARING;
+    lock.unlock();
+    prepare(asset);
+    lock.lock();
+  }
+  while (entry.state == PREPARING)
+    prepared.wait(lock);
+  if ((entry.state != READY) || (lod < 0) || (lod >= (int)entry.lods.size()))
+    return boost::shared_ptr<IndexedModel>();
+  return entry.lods[lod];
+}
+
+void ModelAssets::release(Asset asset)
+{
+  vector< boost::shared_ptr<IndexedModel> > lods; // freed after unlocking
+  boost::mutex::scoped_lock lock(mutex);
+  if (entries[asset].state == PREPARING)
+    return;
+  entries[asset].lods.swap(lods);
+  entries[asset].state = NOT_PREPARED;
+}
+
+size_t ModelAssets::gpuMemory(Asset asset) const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  size_t bytes = 0;
+  for (size_t l=0; l<entries[asset].lods.size(); ++l)
+    bytes += entries[asset].lods[l]->gpuMemory();
+  return bytes;
+}
+
+size_t ModelAssets::gpuMemory() const
+{
+  size_t bytes = 0;
+  for (int a=0; a<NB_ASSETS; ++a)
+    bytes += gpuMemory((Asset)a);
+  return bytes;
+}
+
+void ModelAssets::printReport(std::ostream &out) const
+{
+  const char *stateNames[] = {"not prepared", "preparing", "ready", "failed"};
+  boost::mutex::scoped_lock lock(mutex);
+  for (int a=0; a<NB_ASSETS; ++a) {
+    const Entry &entry = entries[a];
+    out << "ModelAssets: " << assetNames[a] << " " << stateNames[entry.state];
+    if (entry.state == READY) {
+      size_t bytes = 0;
+      out << ", triangles per level:";
+      for (size_t l=0; l<entry.lods.size(); ++l) {
+        out << " " << entry.lods[l]->nbTriangles();
+        bytes += entry.lods[l]->gpuMemory();
+      }
+      out << ", GPU memory " << bytes/1024 << " KB, " << entry.lods[0].use_count()-1 << " users";
+    }
+    out << endl;
+  }
+}
+
+} // namespace
@@ -0,0 +1,140 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Gui3DQt/ObjectListRenderer.hpp"
+#include "Gui3DQt/EllipseInstances.hpp"
+
+#include <math.h>
+#include <stdio.h>
+
+#define DEFAULT_VELOCITY_SCALE  1.0 // s
+#define DEFAULT_LABEL_SIZE      0.8 // m
+#define ARROW_HEAD_LENGTH       0.5 // m
+#define LABEL_Z                 1.0 // m, as draw_observed_car()
+
+using namespace std;
+
+namespace Gui3DQt {
+
+static vector<GLfloat> make_shape(const GLfloat *xy, int nbVertices)
+{
+  return vector<GLfloat>(xy, xy + 2*nbVertices);
+}
+
+ObjectListRenderer::ObjectListRenderer()
+  : velocityScale(DEFAULT_VELOCITY_SCALE)
+{
+  // unit shapes, scaled per instance by the object dimensions
+  const GLfloat box[] = {0.5,0.5, 0.5,-0.5, -0.5,-0.5, -0.5,0.5};
+  const GLfloat line[] = {0.25,0, 0.75,0}; // heading line of draw_bounding_box(), scaled by the length
+  const GLfloat shaft[] = {0,0, 1,0};
+  const GLfloat head[] = {0,0, -1,0.5, -1,-0.5}; // tip at the origin
+  boxFill = shapes.addShape(GL_TRIANGLE_FAN, make_shape(box, 4));
+  boxOutline = shapes.addShape(GL_LINE_LOOP, make_shape(box, 4));
+  heading = shapes.addShape(GL_LINES, make_shape(line, 2));
+  arrowShaft = shapes.addShape(GL_LINES, make_shape(shaft, 2));
+  arrowHead = shapes.addShape(GL_TRIANGLES, make_shape(head, 3));
+  ellipse = shapes.addShape(GL_LINE_LOOP, EllipseInstances::unitCircle(20, false));
+  shapes.setLineWidth(2);
+  labels.setSize(DEFAULT_LABEL_SIZE);
+}
+
+ObjectListRenderer::~ObjectListRenderer()
+{
+}
+
+void ObjectListRenderer::setObjects(const vector<Object> &objects_)
+{
+  objects = objects_;
+  buildShapes();
+}
+
+void ObjectListRenderer::clear()
+{
+  objects.clear();
+  buildShapes();
+}
+
+size_t ObjectListRenderer::size() const
+{
+  return objects.size();
+}
+
+void ObjectListRenderer::setVelocityScale(double seconds)
+{
+  velocityScale = seconds;
+  buildShapes();
+}
+
+void ObjectListRenderer::setLabelSize(double size)
+{
+  labels.setSize(size);
+}
+
+void ObjectListRenderer::buildShapes()
+{
+  shapes.clear();
+  labels.clear();
+  char text[100];
+  for (int s = boxFill; s <= ellipse; ++s)
+    shapes.reserve(s, objects.size());
+  for (vector<Object>::const_iterator o = objects.begin(); o != objects.end(); ++o) {
+    if (o->published)
+      shapes.setColor(0, 1, 0, 0.7);
+    else
+      shapes.setColor(1, 1, 1, 0.7);
+    shapes.addInstance(boxFill, o->x, o->y, o->theta, o->length, o->width);
+    shapes.addInstance(boxOutline, o->x, o->y, o->theta, o->length, o->width);
+    shapes.addInstance(heading, o->x, o->y, o->theta, o->length, 1);
+    double len = o->velocity * velocityScale;
+    if (fabs(len) > 1e-3) {
+      double dir = (len > 0) ? o->theta : o->theta + M_PI;
+      len = fabs(len);
+      shapes.addInstance(arrowShaft, o->x, o->y, dir, len, 1);
+      shapes.addInstance(arrowHead, o->x + len*cos(dir), o->y + len*sin(dir), dir, ARROW_HEAD_LENGTH, ARROW_HEAD_LENGTH);
+    }
+    shapes.setColor(0.6, 0.6, 0, 0.5);
+    shapes.addInstance(ellipse, o->x, o->y, 0, sqrt(o->xVar), sqrt(o->yVar));
+    if (o->showLabel) {
+      sprintf(text, "%d", (int)o->confidence);
+      labels.setColor(1, 0, 0);
+      labels.add(o->x, o->y, LABEL_Z, text, true);
+      sprintf(text, "ID:  %d\nX:   %.2f\nY:   %.2f\nVEL: %.2f m/s\nDIR: %.2f", o->id, o->x, o->y, o->velocity, o->theta);
+      labels.setColor(1, 1, 1);
+      labels.add(o->x + 0.5*o->length, o->y + 0.5*o->width, LABEL_Z, text);
+    }
+  }
+}
+
+void ObjectListRenderer::render()
+{
+  if (objects.empty())
+    return;
+  glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_LINE_BIT | GL_CURRENT_BIT);
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glEnable(GL_LINE_SMOOTH);
+  shapes.render();
+  labels.render();
+  glPopAttrib();
+}
+
+} // namespace
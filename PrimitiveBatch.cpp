@@ -0,0 +1,285 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Gui3DQt/PrimitiveBatch.hpp"
+#include "Gui3DQt/graphics.hpp"
+
+#include <math.h>
+#include <stddef.h>
+#include <algorithm>
+
+#define CIRCLE_SEGMENTS 20 // same as draw_circle()
+
+using namespace std;
+
+namespace Gui3DQt {
+
+static inline GLubyte toByte(float c)
+{
+  return (GLubyte)(max(0.0f, min(1.0f, c))*255.0f + 0.5f);
+}
+
+PrimitiveBatch::PrimitiveBatch()
+  : lineWidth(1)
+  , pointSize(1)
+  , dirty(false)
+  , buffer(QGLBuffer::VertexBuffer)
+  , bufferCapacity(0)
+  , nbTriangleVertices(0)
+  , nbLineVertices(0)
+  , nbPointVertices(0)
+{
+  setColor(1,1,1,1);
+}
+
+PrimitiveBatch::~PrimitiveBatch()
+{
+  buffer.destroy();
+}
+
+void PrimitiveBatch::clear()
+{
+  triangles.clear();
+  lines.clear();
+  points.clear();
+  dirty = true;
+}
+
+bool PrimitiveBatch::empty() const
+{
+  return triangles.empty() && lines.empty() && points.empty();
+}
+
+void PrimitiveBatch::setColor(float r, float g, float b, float a)
+{
+  color.r = toByte(r);
+  color.g = toByte(g);
+  color.b = toByte(b);
+  color.a = toByte(a);
+}
+
+void PrimitiveBatch::setLineWidth(float width)
+{
+  lineWidth = width;
+}
+
+void PrimitiveBatch::setPointSize(float size)
+{
+  pointSize = size;
+}
+
+void PrimitiveBatch::addVertex(vector<Vertex> &list, double x, double y, double z)
+{
+  Vertex v = color;
+  v.x = x; v.y = y; v.z = z;
+  list.push_back(v);
+  dirty = true;
+}
+
+void PrimitiveBatch::point(double x, double y, double z)
+{
+  addVertex(points, x, y, z);
+}
+
+void PrimitiveBatch::line(double x1, double y1, double x2, double y2, double z)
+{
+  addVertex(lines, x1, y1, z);
+  addVertex(lines, x2, y2, z);
+}
+
+void PrimitiveBatch::line3D(double x1, double y1, double z1, double x2, double y2, double z2)
+{
+  addVertex(lines, x1, y1, z1);
+  addVertex(lines, x2, y2, z2);
+}
+
+void PrimitiveBatch::dashedLine(double x1, double y1, double x2, double y2, double stripe_len, double z)
+{
+  double frac = stripe_len / hypot(x2 - x1, y2 - y1);
+  double dx = frac * (x2 - x1);
+  double dy = frac * (y2 - y1);
+  double x = x1, y = y1;
+  for (int i = 0; i < (int)floor(1 / frac); i++) {
+    if (i % 2 == 0)
+      line(x, y, x + dx, y + dy, z);
+    x += dx;
+    y += dy;
+  }
+}
+
+void PrimitiveBatch::circle(double x, double y, double r, bool filled, double z)
+{
+  ellipse(x, y, r, r, filled, z);
+}
+
+void PrimitiveBatch::ellipse(double x, double y, double rx, double ry, bool filled, double z)
+{
+  static const double *c = Graphics::unit_circle(CIRCLE_SEGMENTS); // looked up once, records may run in worker threads
+  for (int i = 0; i < CIRCLE_SEGMENTS; i++) {
+    int j = (i+1) % CIRCLE_SEGMENTS;
+    if (filled) {
+      addVertex(triangles, x, y, z);
+      addVertex(triangles, x + rx*c[2*i], y + ry*c[2*i+1], z);
+      addVertex(triangles, x + rx*c[2*j], y + ry*c[2*j+1], z);
+    } else {
+      line(x + rx*c[2*i], y + ry*c[2*i+1], x + rx*c[2*j], y + ry*c[2*j+1], z);
+    }
+  }
+}
+
+void PrimitiveBatch::diamond(double x, double y, double r, double z)
+{
+  addVertex(triangles, x + r, y, z);
+  addVertex(triangles, x, y + r, z);
+  addVertex(triangles, x - r, y, z);
+  addVertex(triangles, x - r, y, z);
+  addVertex(triangles, x, y - r, z);
+  addVertex(triangles, x + r, y, z);
+}
+
+void PrimitiveBatch::arrow(double x1, double y1, double x2, double y2, double head_width, double head_length, double z)
+{
+  line(x1, y1, x2, y2, z);
+  double angle = atan2(y2 - y1, x2 - x1);
+  double ct = cos(angle);
+  double st = sin(angle);
+  addVertex(triangles, x2, y2, z);
+  addVertex(triangles, x2 - head_length * ct + head_width * st, y2 - head_length * st - head_width * ct, z);
+  addVertex(triangles, x2 - head_length * ct - head_width * st, y2 - head_length * st + head_width * ct, z);
+}
+
+void PrimitiveBatch::arrowhead(double x, double y, double angle, double z)
+{
+  const double l = 2, l2 = 0.5; // same as draw_arrowhead()
+  double ct = cos(angle);
+  double st = sin(angle);
+  addVertex(triangles, x, y, z);
+  addVertex(triangles, x - l * ct + l2 * st, y - l * st - l2 * ct, z);
+  addVertex(triangles, x - l * ct - l2 * st, y - l * st + l2 * ct, z);
+}
+
+void PrimitiveBatch::boundingBox(double x, double y, double theta, double w, double l, double z)
+{
+  double ct = cos(theta), st = sin(theta);
+  // corners in the box frame: front left, front right, rear right, rear left
+  double cx[4] = {l/2, l/2, -l/2, -l/2};
+  double cy[4] = {w/2, -w/2, -w/2, w/2};
+  double px[4], py[4];
+  for (int i=0; i<4; ++i) {
+    px[i] = x + ct*cx[i] - st*cy[i];
+    py[i] = y + st*cx[i] + ct*cy[i];
+  }
+  addVertex(triangles, px[0], py[0], z);
+  addVertex(triangles, px[1], py[1], z);
+  addVertex(triangles, px[2], py[2], z);
+  addVertex(triangles, px[2], py[2], z);
+  addVertex(triangles, px[3], py[3], z);
+  addVertex(triangles, px[0], py[0], z);
+  for (int i=0; i<4; ++i)
+    line(px[i], py[i], px[(i+1)%4], py[(i+1)%4], z);
+  line(x + ct*l/4, y + st*l/4, x + ct*l*3/4, y + st*l*3/4, z); // heading
+}
+
+void PrimitiveBatch::cubeSolid(float x1, float x2, float y1, float y2, float z1, float z2)
+{
+  const float q[6][4][3] = { // same faces as draw_cube_solid()
+    {{x1,y1,z1},{x2,y1,z1},{x2,y2,z1},{x1,y2,z1}},
+    {{x1,y2,z1},{x2,y2,z1},{x2,y2,z2},{x1,y2,z2}},
+    {{x1,y2,z2},{x2,y2,z2},{x2,y1,z2},{x1,y1,z2}},
+    {{x1,y1,z2},{x2,y1,z2},{x2,y1,z1},{x1,y1,z1}},
+    {{x1,y1,z1},{x1,y2,z1},{x1,y2,z2},{x1,y1,z2}},
+    {{x2,y2,z1},{x2,y1,z1},{x2,y1,z2},{x2,y2,z2}}};
+  const int order[6] = {0,1,2,2,3,0}; // two triangles per quad
+  for (int f=0; f<6; ++f)
+    for (int i=0; i<6; ++i)
+      addVertex(triangles, q[f][order[i]][0], q[f][order[i]][1], q[f][order[i]][2]);
+}
+
+void PrimitiveBatch::cubeCage(float x1, float x2, float y1, float y2, float z1, float z2)
+{
+  for (int i=0; i<4; ++i) { // edges along x, y and z
+    float a = (i&1) ? y2 : y1, b = (i&2) ? z2 : z1;
+    line3D(x1, a, b, x2, a, b);
+    a = (i&1) ? x2 : x1;
+    line3D(a, y1, b, a, y2, b);
+    b = (i&2) ? y2 : y1;
+    line3D(a, b, z1, a, b, z2);
+  }
+}
+
+void PrimitiveBatch::upload()
+{
+  GLsizei total = triangles.size() + lines.size() + points.size();
+  if (!buffer.isCreated()) {
+    if (!buffer.create())
+      return;
+    buffer.setUsagePattern(QGLBuffer::StaticDraw); // rebuilt only when the data changes
+  }
+  buffer.bind();
+  if (total > bufferCapacity) { // grow, otherwise the storage is reused
+    bufferCapacity = total + total/2;
+    buffer.allocate(bufferCapacity*sizeof(Vertex));
+  }
+  int offset = 0;
+  if (!triangles.empty())
+    buffer.write(offset, &triangles[0], triangles.size()*sizeof(Vertex));
+  offset += triangles.size()*sizeof(Vertex);
+  if (!lines.empty())
+    buffer.write(offset, &lines[0], lines.size()*sizeof(Vertex));
+  offset += lines.size()*sizeof(Vertex);
+  if (!points.empty())
+    buffer.write(offset, &points[0], points.size()*sizeof(Vertex));
+  buffer.release();
+  nbTriangleVertices = triangles.size();
+  nbLineVertices = lines.size();
+  nbPointVertices = points.size();
+  dirty = false;
+}
+
+void PrimitiveBatch::render()
+{
+  if (dirty)
+    upload();
+  if (!buffer.isCreated() || (nbTriangleVertices + nbLineVertices + nbPointVertices == 0))
+    return;
+  buffer.bind();
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+  glVertexPointer(3, GL_FLOAT, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, x));
+  glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, r));
+  if (nbTriangleVertices > 0)
+    glDrawArrays(GL_TRIANGLES, 0, nbTriangleVertices);
+  if (nbLineVertices > 0) {
+    glLineWidth(lineWidth);
+    glDrawArrays(GL_LINES, nbTriangleVertices, nbLineVertices);
+    glLineWidth(1);
+  }
+  if (nbPointVertices > 0) {
+    glPointSize(pointSize);
+    glDrawArrays(GL_POINTS, nbTriangleVertices + nbLineVertices, nbPointVertices);
+    glPointSize(1);
+  }
+  glPopClientAttrib();
+  buffer.release();
+}
+
+} // namespace
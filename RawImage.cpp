@@ -0,0 +1,126 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Gui3DQt/RawImage.hpp"
+
+#include <math.h>
+#include <algorithm>
+
+#define DEFAULT_MAX_DEPTH 50.0f
+
+using namespace std;
+
+namespace Gui3DQt {
+
+RawImage::RawImage(PixelFormat fmt, int w, int h)
+  : format(fmt)
+  , width(w)
+  , height(h)
+  , rangeMin(0)
+{
+  stride = w*bytesPerPixel();
+  data.reset(new unsigned char[(size_t)stride*h]);
+  switch (fmt) {
+    case PF_Gray16:    rangeMax = 65535; break;
+    case PF_Depth32F:  rangeMax = DEFAULT_MAX_DEPTH; break;
+    default:           rangeMax = 255;
+  }
+}
+
+int RawImage::bytesPerPixel() const
+{
+  switch (format) {
+    case PF_Gray16:    return 2;
+    case PF_Depth32F:  return 4;
+    default:           return 1;
+  }
+}
+
+bool RawImage::isBayer() const
+{
+  return (format == PF_BayerRGGB8) || (format == PF_BayerBGGR8) || (format == PF_BayerGRBG8) || (format == PF_BayerGBRG8);
+}
+
+static inline unsigned char clampByte(float v)
+{
+  return (unsigned char)max(0.0f, min(255.0f, v + 0.5f));
+}
+
+static inline QRgb jet(float v) // v = 0..1, same as in the shader of ImageView
+{
+  v = max(0.0f, min(1.0f, v));
+  float r = 1.5f-fabs(4.0f*v-3.0f), g = 1.5f-fabs(4.0f*v-2.0f), b = 1.5f-fabs(4.0f*v-1.0f);
+  return qRgb(clampByte(255.0f*r), clampByte(255.0f*g), clampByte(255.0f*b));
+}
+
+QImage RawImage::toQImage() const
+{
+  if (isNull())
+    return QImage();
+  QImage img(width, height, QImage::Format_RGB32);
+  const float scale = (rangeMax > rangeMin) ? 255.0f/(rangeMax-rangeMin) : 1.0f;
+  if (isBayer()) {
+    // bilinear demosaicing as in the shader of ImageView, borders are clamped like the texture
+    const int rx = ((format == PF_BayerGRBG8) || (format == PF_BayerBGGR8)) ? 1 : 0; // position of the red pixel
+    const int ry = ((format == PF_BayerGBRG8) || (format == PF_BayerBGGR8)) ? 1 : 0;
+    for (int y=0; y<height; ++y) {
+      const unsigned char *lu = constScanLine(max(y-1, 0)), *l = constScanLine(y), *ld = constScanLine(min(y+1, height-1));
+      QRgb *out = (QRgb*)img.scanLine(y);
+      for (int x=0; x<width; ++x) {
+        const int xl = max(x-1, 0), xr = min(x+1, width-1);
+        const float c = l[x];
+        const float crossAvg = 0.25f*(l[xl] + l[xr] + lu[x] + ld[x]);
+        const float diagAvg = 0.25f*(lu[xl] + lu[xr] + ld[xl] + ld[xr]);
+        const float horizAvg = 0.5f*(l[xl] + l[xr]);
+        const float vertAvg = 0.5f*(lu[x] + ld[x]);
+        const bool redCol = ((x + rx) % 2 == 0), redRow = ((y + ry) % 2 == 0);
+        float r, g, b;
+        if (redCol && redRow)        { r = c;        g = crossAvg; b = diagAvg; }
+        else if (!redCol && !redRow) { r = diagAvg;  g = crossAvg; b = c; }
+        else if (redRow)             { r = horizAvg; g = c;        b = vertAvg; } // green in red row
+        else                         { r = vertAvg;  g = c;        b = horizAvg; } // green in blue row
+        out[x] = qRgb(clampByte((r-rangeMin)*scale), clampByte((g-rangeMin)*scale), clampByte((b-rangeMin)*scale));
+      }
+    }
+    return img;
+  }
+  for (int y=0; y<height; ++y) {
+    QRgb *out = (QRgb*)img.scanLine(y);
+    switch (format) {
+      case PF_Gray8: {
+        const unsigned char *in = constScanLine(y);
+        for (int x=0; x<width; ++x) { unsigned char v = clampByte((in[x]-rangeMin)*scale); out[x] = qRgb(v,v,v); }
+        break; }
+      case PF_Gray16: {
+        const unsigned short *in = (const unsigned short*)constScanLine(y);
+        for (int x=0; x<width; ++x) { unsigned char v = clampByte((in[x]-rangeMin)*scale); out[x] = qRgb(v,v,v); }
+        break; }
+      case PF_Depth32F: {
+        const float *in = (const float*)constScanLine(y);
+        for (int x=0; x<width; ++x) out[x] = (in[x] > 0.0f) ? jet((in[x]-rangeMin)*scale/255.0f) : qRgb(0,0,0); // false for NaN
+        break; }
+      default: break;
+    }
+  }
+  return img;
+}
+
+} // namespace
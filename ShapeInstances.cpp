@@ -0,0 +1,275 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Gui3DQt/ShapeInstances.hpp"
+#include "Instancing.hpp"
+
+#include <math.h>
+#include <stddef.h>
+#include <iostream>
+#include <algorithm>
+#include <QtOpenGL/QGLShaderProgram>
+
+using namespace std;
+
+namespace Gui3DQt {
+
+// transforms the unit shape by the per-instance attributes
+static const char *instanceVertexShader =
+  "#version 120\n"
+  "attribute vec2 unitPos;\n"
+  "attribute vec4 pose;\n" // x, y, z, theta
+  "attribute vec2 scale;\n"
+  "attribute vec4 color;\n"
+  "void main() {\n"
+  "  vec2 p = unitPos * scale;\n"
+  "  float c = cos(pose.w);\n"
+  "  float s = sin(pose.w);\n"
+  "  gl_FrontColor = color;\n"
+  "  gl_Position = gl_ModelViewProjectionMatrix * vec4(pose.x + c*p.x - s*p.y, pose.y + s*p.x + c*p.y, pose.z, 1.0);\n"
+  "}\n";
+
+static const char *instanceFragmentShader =
+  "void main() {\n"
+  "  gl_FragColor = gl_Color;\n"
+  "}\n";
+
+static inline GLubyte toByte(float c)
+{
+  return (GLubyte)(max(0.0f, min(1.0f, c))*255.0f + 0.5f);
+}
+
+ShapeInstances::ShapeInstances()
+  : lineWidth(1)
+  , meshDirty(false)
+  , dirty(false)
+  , initialized(false)
+  , meshBuffer(QGLBuffer::VertexBuffer)
+  , instanceBuffer(QGLBuffer::VertexBuffer)
+  , instanceCapacity(0)
+  , program(NULL)
+  , instancing(NULL)
+{
+  setColor(1,1,1,1);
+}
+
+ShapeInstances::~ShapeInstances()
+{
+  delete program;
+  delete instancing;
+  instanceBuffer.destroy();
+  meshBuffer.destroy();
+}
+
+int ShapeInstances::addShape(GLenum mode, const vector<GLfloat> &xy)
+{
+  Shape s;
+  s.mode = mode;
+  s.first = mesh.size()/2;
+  s.count = xy.size()/2;
+  s.firstInstance = 0;
+  s.nbInstances = 0;
+  mesh.insert(mesh.end(), xy.begin(), xy.begin() + 2*s.count);
+  shapes.push_back(s);
+  meshDirty = true;
+  return shapes.size()-1;
+}
+
+void ShapeInstances::clear()
+{
+  for (vector<Shape>::iterator s = shapes.begin(); s != shapes.end(); ++s)
+    s->instances.clear();
+  dirty = true;
+}
+
+size_t ShapeInstances::size() const
+{
+  size_t n = 0;
+  for (vector<Shape>::const_iterator s = shapes.begin(); s != shapes.end(); ++s)
+    n += s->instances.size();
+  return n;
+}
+
+void ShapeInstances::reserve(int shape, size_t nbInstances)
+{
+  shapes.at(shape).instances.reserve(nbInstances);
+}
+
+void ShapeInstances::setColor(float r, float g, float b, float a)
+{
+  color.r = toByte(r);
+  color.g = toByte(g);
+  color.b = toByte(b);
+  color.a = toByte(a);
+}
+
+void ShapeInstances::setLineWidth(float width)
+{
+  lineWidth = width;
+}
+
+void ShapeInstances::addInstance(int shape, double x, double y, double theta, double sx, double sy, double z)
+{
+  Instance i = color;
+  i.x = x; i.y = y; i.z = z; i.theta = theta;
+  i.sx = sx; i.sy = sy;
+  shapes[shape].instances.push_back(i);
+  dirty = true;
+}
+
+void ShapeInstances::initialize()
+{
+  initialized = true;
+  instancing = new Instancing::Functions();
+  if (!Instancing::resolve(instancing->drawArraysInstanced, instancing->vertexAttribDivisor)) {
+    cout << "ShapeInstances: instancing not supported, drawing shapes one by one" << endl;
+    return;
+  }
+  program = new QGLShaderProgram();
+  program->bindAttributeLocation("unitPos", 0); // attribute 0 must not be instanced
+  if (!program->addShaderFromSourceCode(QGLShader::Vertex, instanceVertexShader)
+      || !program->addShaderFromSourceCode(QGLShader::Fragment, instanceFragmentShader)
+      || !program->link()) {
+    cerr << "ShapeInstances: instancing shader not available, drawing shapes one by one" << endl << program->log().toStdString() << endl;
+    delete program;
+    program = NULL;
+  }
+}
+
+void ShapeInstances::uploadMesh()
+{
+  if (!meshBuffer.isCreated()) {
+    if (!meshBuffer.create())
+      return;
+    meshBuffer.setUsagePattern(QGLBuffer::StaticDraw);
+  }
+  meshBuffer.bind();
+  meshBuffer.allocate(&mesh[0], mesh.size()*sizeof(GLfloat));
+  meshBuffer.release();
+  meshDirty = false;
+}
+
+void ShapeInstances::uploadInstances()
+{
+  GLsizei total = size();
+  if (!instanceBuffer.isCreated()) {
+    if (!instanceBuffer.create())
+      return;
+    instanceBuffer.setUsagePattern(QGLBuffer::DynamicDraw);
+  }
+  instanceBuffer.bind();
+  if (total > instanceCapacity) { // grow, otherwise the storage is reused
+    instanceCapacity = total + total/2;
+    instanceBuffer.allocate(instanceCapacity*sizeof(Instance));
+  }
+  GLsizei first = 0;
+  for (vector<Shape>::iterator s = shapes.begin(); s != shapes.end(); ++s) {
+    s->firstInstance = first;
+    s->nbInstances = s->instances.size();
+    if (s->nbInstances > 0)
+      instanceBuffer.write(first*sizeof(Instance), &s->instances[0], s->nbInstances*sizeof(Instance));
+    first += s->nbInstances;
+  }
+  instanceBuffer.release();
+  dirty = false;
+}
+
+void ShapeInstances::renderInstanced(const Shape &shape)
+{
+  if (shape.nbInstances == 0)
+    return;
+  // there is no base instance in OpenGL 2/3, so the attribute offsets are moved instead
+  const int stride = sizeof(Instance);
+  const int base = shape.firstInstance*stride;
+  instanceBuffer.bind();
+  program->setAttributeBuffer("pose", GL_FLOAT, base + offsetof(Instance, x), 4, stride);
+  program->setAttributeBuffer("scale", GL_FLOAT, base + offsetof(Instance, sx), 2, stride);
+  program->setAttributeBuffer("color", GL_UNSIGNED_BYTE, base + offsetof(Instance, r), 4, stride); // normalized by Qt
+  instanceBuffer.release();
+  instancing->drawArraysInstanced(shape.mode, shape.first, shape.count, shape.nbInstances);
+}
+
+void ShapeInstances::renderLoop(const Shape &shape)
+{
+  for (vector<Instance>::const_iterator i = shape.instances.begin(); i != shape.instances.end(); ++i) {
+    glColor4ub(i->r, i->g, i->b, i->a);
+    glPushMatrix();
+    glTranslatef(i->x, i->y, i->z);
+    glRotatef(i->theta*180.0/M_PI, 0, 0, 1);
+    glScalef(i->sx, i->sy, 1);
+    glDrawArrays(shape.mode, shape.first, shape.count);
+    glPopMatrix();
+  }
+}
+
+void ShapeInstances::render()
+{
+  if (!initialized)
+    initialize();
+  if (meshDirty)
+    uploadMesh();
+  if (!meshBuffer.isCreated())
+    return;
+  if (program && dirty)
+    uploadInstances();
+  if (size() == 0)
+    return;
+
+  glPushAttrib(GL_CURRENT_BIT | GL_LINE_BIT);
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+  glLineWidth(lineWidth);
+  meshBuffer.bind();
+  if (program) {
+    program->bind();
+    const int pose = program->attributeLocation("pose");
+    const int scale = program->attributeLocation("scale");
+    const int col = program->attributeLocation("color");
+    program->setAttributeBuffer(0, GL_FLOAT, 0, 2);
+    program->enableAttributeArray(0);
+    meshBuffer.release();
+    program->enableAttributeArray(pose);
+    program->enableAttributeArray(scale);
+    program->enableAttributeArray(col);
+    instancing->vertexAttribDivisor(pose, 1);
+    instancing->vertexAttribDivisor(scale, 1);
+    instancing->vertexAttribDivisor(col, 1);
+    for (vector<Shape>::const_iterator s = shapes.begin(); s != shapes.end(); ++s)
+      renderInstanced(*s);
+    instancing->vertexAttribDivisor(pose, 0);
+    instancing->vertexAttribDivisor(scale, 0);
+    instancing->vertexAttribDivisor(col, 0);
+    program->disableAttributeArray(col);
+    program->disableAttributeArray(scale);
+    program->disableAttributeArray(pose);
+    program->disableAttributeArray(0);
+    program->release();
+  } else {
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, 0);
+    meshBuffer.release();
+    for (vector<Shape>::const_iterator s = shapes.begin(); s != shapes.end(); ++s)
+      renderLoop(*s);
+  }
+  glPopClientAttrib();
+  glPopAttrib();
+}
+
+} // namespace
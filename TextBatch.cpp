@@ -0,0 +1,393 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Gui3DQt/TextBatch.hpp"
+#include "Gui3DQt/GLState.hpp"
+
+#include <stddef.h>
+#include <iostream>
+#include <algorithm>
+#include <QPainter>
+#include <QFontMetrics>
+#include <QtOpenGL/QGLContext>
+#include <QtOpenGL/QGLShaderProgram>
+
+#define ATLAS_WIDTH   512
+#define GLYPH_PADDING 2 // pixels around each glyph against bleeding of neighbors
+#define FIRST_CHAR    32
+#define LAST_CHAR     126
+
+using namespace std;
+
+namespace Gui3DQt {
+
+// world space: offset in the x-y plane, screen space: offset in pixels after projecting the anchor
+static const char *textVertexShader =
+  "#version 120\n"
+  "attribute vec3 anchor;\n"
+  "attribute vec2 offset;\n"
+  "attribute vec2 texCoord;\n"
+  "attribute vec4 color;\n"
+  "uniform float size;\n"
+  "uniform vec2 viewport;\n"
+  "uniform int screenSpace;\n"
+  "void main() {\n"
+  "  if (screenSpace != 0) {\n"
+  "    vec4 p = gl_ModelViewProjectionMatrix * vec4(anchor, 1.0);\n"
+  "    p.xy += offset * size * 2.0 / viewport * p.w;\n"
+  "    gl_Position = p;\n"
+  "  } else {\n"
+  "    gl_Position = gl_ModelViewProjectionMatrix * vec4(anchor + vec3(offset * size, 0.0), 1.0);\n"
+  "  }\n"
+  "  gl_TexCoord[0] = vec4(texCoord, 0.0, 1.0);\n"
+  "  gl_FrontColor = color;\n"
+  "}\n";
+
+static const char *textFragmentShader =
+  "uniform sampler2D tex;\n"
+  "void main() {\n"
+  "  gl_FragColor = gl_Color * texture2D(tex, gl_TexCoord[0].st);\n"
+  "}\n";
+
+static inline GLubyte toByte(float c)
+{
+  return (GLubyte)(max(0.0f, min(1.0f, c))*255.0f + 0.5f);
+}
+
+TextBatch::TextBatch(const QFont &font_)
+  : font(font_)
+  , rasterized(false)
+  , screenSpace(false)
+  , size(1)
+  , dirty(false)
+  , initialized(false)
+  , texture(0)
+  , buffer(QGLBuffer::VertexBuffer)
+  , bufferCapacity(0)
+  , nbVertices(0)
+  , program(NULL)
+{
+  setColor(1,1,1,1);
+}
+
+void TextBatch::rasterize() const
+{
+  if (rasterized)
+    return;
+  rasterized = true;
+  // layout of the glyphs in rows
+  QFontMetrics metrics(font);
+  const int lineHeight = metrics.height();
+  const int cellHeight = lineHeight + 2*GLYPH_PADDING;
+  int x = 0, y = 0;
+  int pos[LAST_CHAR-FIRST_CHAR+1][2];
+  for (int c = FIRST_CHAR; c <= LAST_CHAR; ++c) {
+    int cellWidth = metrics.width(QChar(c)) + 2*GLYPH_PADDING;
+    if (x + cellWidth > ATLAS_WIDTH) {
+      x = 0;
+      y += cellHeight;
+    }
+    pos[c-FIRST_CHAR][0] = x;
+    pos[c-FIRST_CHAR][1] = y;
+    x += cellWidth;
+  }
+  int height = 1;
+  while (height < y + cellHeight) // power of two for old hardware
+    height *= 2;
+
+  atlas = QImage(ATLAS_WIDTH, height, QImage::Format_ARGB32_Premultiplied);
+  atlas.fill(Qt::transparent);
+  QPainter painter(&atlas);
+  painter.setFont(font);
+  painter.setPen(Qt::white);
+  for (int c = FIRST_CHAR; c <= LAST_CHAR; ++c) {
+    const int gx = pos[c-FIRST_CHAR][0] + GLYPH_PADDING;
+    const int gy = pos[c-FIRST_CHAR][1] + GLYPH_PADDING;
+    const int advance = metrics.width(QChar(c));
+    painter.drawText(gx, gy + metrics.ascent(), QString(QChar(c)));
+    Glyph &g = glyphs[c-FIRST_CHAR];
+    g.s0 = gx / (GLfloat)ATLAS_WIDTH;
+    g.s1 = (gx + advance) / (GLfloat)ATLAS_WIDTH;
+    g.t0 = 1.0f - gy / (GLfloat)height; // texture is uploaded with inverted y
+    g.t1 = 1.0f - (gy + lineHeight) / (GLfloat)height;
+    g.width = advance / (GLfloat)lineHeight;
+  }
+  painter.end();
+  descent = metrics.descent() / (GLfloat)lineHeight;
+}
+
+TextBatch::~TextBatch()
+{
+  delete program;
+  buffer.destroy();
+  if (texture && QGLContext::currentContext())
+    const_cast<QGLContext*>(QGLContext::currentContext())->deleteTexture(texture);
+}
+
+void TextBatch::clear()
+{
+  vertices.clear();
+  dirty = true;
+}
+
+bool TextBatch::empty() const
+{
+  return vertices.empty();
+}
+
+void TextBatch::setColor(float r, float g, float b, float a)
+{
+  color[0] = toByte(r*a);
+  color[1] = toByte(g*a);
+  color[2] = toByte(b*a);
+  color[3] = toByte(a);
+}
+
+void TextBatch::setScreenSpace(bool screenSpace_)
+{
+  screenSpace = screenSpace_;
+}
+
+void TextBatch::setSize(double lineHeight)
+{
+  size = lineHeight;
+}
+
+const TextBatch::Glyph& TextBatch::glyph(char c) const
+{
+  rasterize();
+  if ((c < FIRST_CHAR) || (c > LAST_CHAR))
+    c = '?';
+  return glyphs[c-FIRST_CHAR];
+}
+
+double TextBatch::textWidth(const string &text) const
+{
+  double width = 0, lineWidth = 0;
+  for (string::const_iterator c = text.begin(); c != text.end(); ++c) {
+    if (*c == '\n') {
+      lineWidth = 0;
+      continue;
+    }
+    lineWidth += glyph(*c).width;
+    width = max(width, lineWidth);
+  }
+  return width;
+}
+
+void TextBatch::add(double x, double y, double z, const string &text, bool centered)
+{
+  rasterize();
+  Vertex v;
+  v.x = x; v.y = y; v.z = z;
+  v.r = color[0]; v.g = color[1]; v.b = color[2]; v.a = color[3];
+  size_t lineStart = 0;
+  GLfloat oy = -descent; // bottom of the first line
+  while (lineStart <= text.size()) {
+    size_t lineEnd = min(text.find('\n', lineStart), text.size());
+    string line = text.substr(lineStart, lineEnd-lineStart);
+    GLfloat ox = centered ? -0.5*textWidth(line) : 0;
+    for (string::const_iterator c = line.begin(); c != line.end(); ++c) {
+      const Glyph &g = glyph(*c);
+      if (*c != ' ') { // counter-clockwise quad
+        v.ox = ox;         v.oy = oy;     v.s = g.s0; v.t = g.t1; vertices.push_back(v);
+        v.ox = ox+g.width; v.oy = oy;     v.s = g.s1; v.t = g.t1; vertices.push_back(v);
+        v.ox = ox+g.width; v.oy = oy + 1; v.s = g.s1; v.t = g.t0; vertices.push_back(v);
+        v.ox = ox;         v.oy = oy + 1; v.s = g.s0; v.t = g.t0; vertices.push_back(v);
+      }
+      ox += g.width;
+    }
+    oy -= 1;
+    lineStart = lineEnd + 1;
+  }
+  dirty = true;
+}
+
+void TextBatch::initialize()
+{
+  initialized = true;
+  QGLContext *context = const_cast<QGLContext*>(QGLContext::currentContext());
+  if (!context)
+    return;
+  rasterize();
+  texture = context->bindTexture(atlas, GL_TEXTURE_2D, GL_RGBA,
+      QGLContext::InvertedYBindOption | QGLContext::LinearFilteringBindOption
+      | QGLContext::MipmapBindOption | QGLContext::PremultipliedAlphaBindOption);
+  atlas = QImage(); // not needed anymore
+  if (!QGLShaderProgram::hasOpenGLShaderPrograms())
+    return;
+  program = new QGLShaderProgram();
+  program->bindAttributeLocation("anchor", 0);
+  if (!program->addShaderFromSourceCode(QGLShader::Vertex, textVertexShader)
+      || !program->addShaderFromSourceCode(QGLShader::Fragment, textFragmentShader)
+      || !program->link()) {
+    cerr << "TextBatch: shader not available, positioning text on the CPU" << endl << program->log().toStdString() << endl;
+    delete program;
+    program = NULL;
+  }
+}
+
+void TextBatch::upload()
+{
+  GLsizei total = vertices.size();
+  if (!buffer.isCreated()) {
+    if (!buffer.create())
+      return;
+    buffer.setUsagePattern(QGLBuffer::DynamicDraw);
+  }
+  buffer.bind();
+  if (total > bufferCapacity) { // grow, otherwise the storage is reused
+    bufferCapacity = total + total/2;
+    buffer.allocate(bufferCapacity*sizeof(Vertex));
+  }
+  if (total > 0)
+    buffer.write(0, &vertices[0], total*sizeof(Vertex));
+  buffer.release();
+  nbVertices = total;
+  dirty = false;
+}
+
+void TextBatch::renderShader()
+{
+  if (dirty)
+    upload();
+  if (!buffer.isCreated() || (nbVertices == 0))
+    return;
+  GLint viewport[4];
+  GLState::current().getViewport(viewport);
+  const int stride = sizeof(Vertex);
+  program->bind();
+  program->setUniformValue("tex", 0);
+  program->setUniformValue("size", (GLfloat)size);
+  program->setUniformValue("viewport", (GLfloat)viewport[2], (GLfloat)viewport[3]);
+  program->setUniformValue("screenSpace", screenSpace ? 1 : 0);
+  buffer.bind();
+  program->setAttributeBuffer("anchor", GL_FLOAT, offsetof(Vertex, x), 3, stride);
+  program->setAttributeBuffer("offset", GL_FLOAT, offsetof(Vertex, ox), 2, stride);
+  program->setAttributeBuffer("texCoord", GL_FLOAT, offsetof(Vertex, s), 2, stride);
+  program->setAttributeBuffer("color", GL_UNSIGNED_BYTE, offsetof(Vertex, r), 4, stride);
+  buffer.release();
+  program->enableAttributeArray("anchor");
+  program->enableAttributeArray("offset");
+  program->enableAttributeArray("texCoord");
+  program->enableAttributeArray("color");
+  glDrawArrays(GL_QUADS, 0, nbVertices);
+  program->disableAttributeArray("color");
+  program->disableAttributeArray("texCoord");
+  program->disableAttributeArray("offset");
+  program->disableAttributeArray("anchor");
+  program->release();
+}
+
+void TextBatch::renderFixedFunction()
+{
+  if (vertices.empty())
+    return;
+  GLint viewport[4];
+  GLdouble modelview[16], projection[16];
+  GLState &state = GLState::current();
+  state.getViewport(viewport);
+  state.getProjectionMatrix(projection);
+  glGetDoublev(GL_MODELVIEW_MATRIX, modelview); // the labels may be placed by the caller's transformations
+
+  positions.resize(3*vertices.size());
+  GLfloat *p = &positions[0];
+  GLdouble win[4] = {0,0,0,0}; // window coordinates of the current anchor, w<=0 if behind the camera
+  const Vertex *anchor = NULL;
+  for (vector<Vertex>::const_iterator v = vertices.begin(); v != vertices.end(); ++v, p += 3) {
+    if (!screenSpace) {
+      p[0] = v->x + v->ox*size;
+      p[1] = v->y + v->oy*size;
+      p[2] = v->z;
+      continue;
+    }
+    if (!anchor || (anchor->x != v->x) || (anchor->y != v->y) || (anchor->z != v->z)) { // project each anchor only once
+      anchor = &(*v);
+      GLdouble eye[4], clip[4];
+      for (int i=0; i<4; ++i)
+        eye[i] = modelview[i]*v->x + modelview[4+i]*v->y + modelview[8+i]*v->z + modelview[12+i];
+      for (int i=0; i<4; ++i)
+        clip[i] = projection[i]*eye[0] + projection[4+i]*eye[1] + projection[8+i]*eye[2] + projection[12+i]*eye[3];
+      win[3] = clip[3];
+      if (clip[3] > 0) {
+        win[0] = viewport[0] + (clip[0]/clip[3] + 1) * 0.5 * viewport[2];
+        win[1] = viewport[1] + (clip[1]/clip[3] + 1) * 0.5 * viewport[3];
+        win[2] = 1 - 2*(clip[2]/clip[3] + 1) * 0.5; // depth in the orthographic projection below
+      }
+    }
+    if (win[3] > 0) {
+      p[0] = win[0] + v->ox*size;
+      p[1] = win[1] + v->oy*size;
+      p[2] = win[2];
+    } else {
+      p[0] = p[1] = 0;
+      p[2] = -2; // outside of the orthographic projection
+    }
+  }
+
+  if (screenSpace) {
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(viewport[0], viewport[0]+viewport[2], viewport[1], viewport[1]+viewport[3], -1, 1);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+  }
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+  glVertexPointer(3, GL_FLOAT, 0, &positions[0]);
+  glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &vertices[0].s);
+  glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), &vertices[0].r);
+  glDrawArrays(GL_QUADS, 0, vertices.size());
+  glPopClientAttrib();
+  if (screenSpace) {
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+  }
+}
+
+void TextBatch::render()
+{
+  if (!initialized)
+    initialize();
+  if (!texture)
+    return;
+  glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT | GL_CURRENT_BIT);
+  glDisable(GL_LIGHTING);
+  glDisable(GL_CULL_FACE);
+  glEnable(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA); // the atlas and the colors are premultiplied
+  if (program)
+    renderShader();
+  else
+    renderFixedFunction();
+  glPopAttrib();
+}
+
+} // namespace
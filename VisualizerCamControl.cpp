@@ -22,6 +22,7 @@
 #include "Gui3DQt/VisualizerCamControl.hpp"
 
 #include <vector>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <boost/foreach.hpp>
@@ -63,6 +64,7 @@ VisualizerCamControl::VisualizerCamControl(MNavWidget &mNav_, QWidget *parent)
   connect(ui->pbSetStart, SIGNAL(pressed()), this, SLOT(setStartPos()) );
   connect(ui->pbSetStop, SIGNAL(pressed()), this, SLOT(setEndPos()) );
   connect(ui->pbFly, SIGNAL(toggled(bool)), this, SLOT(fly(bool)) );
+  connect(ui->pbRender, SIGNAL(pressed()), this, SLOT(renderFlight()) );
 }
 
 
@@ -237,32 +239,37 @@ void VisualizerCamControl::setEndPos()
   ui->sbStop->setValue(ui->hsStorage->value());
 }
 
+void VisualizerCamControl::generateTrajectory()
+{
+  trajectory.clear();
+  double stepTimeMS = (double)(ui->sbStepTime->value());
+  double totalTimeMS = (double)(ui->dsbDuration->value())*1000.0;
+  unsigned int trajSize = totalTimeMS/stepTimeMS;
+  unsigned int startIdx = 0;
+  if (ui->rbStartCurrent->isChecked())  startIdx = ui->hsStorage->value();
+  if (ui->rbStartFirst->isChecked())  startIdx = 1;
+  if (ui->rbStartLast->isChecked()) startIdx = ui->hsStorage->maximum();
+  if (ui->rbStartSpecific->isChecked()) startIdx = ui->sbStart->value();
+  unsigned int endIdx = 0;
+  if (ui->rbStopCurrent->isChecked())  endIdx = ui->hsStorage->value();
+  if (ui->rbStopFirst->isChecked())  endIdx = 1;
+  if (ui->rbStopLast->isChecked()) endIdx = ui->hsStorage->maximum();
+  if (ui->rbStopSpecific->isChecked()) endIdx = ui->sbStop->value();
+  // generate trajectory dependent on selected method
+  if (ui->rbInterpolLinear->isChecked())
+    generateLinearTrajectory(startIdx-1, endIdx-1, trajSize);
+  if (ui->rbInterpolSpline->isChecked())
+    generateSplineTrajectory(startIdx-1, endIdx-1, trajSize);
+  //cout << endl << "generated trajectory with " << trajectory.size() << " elements, " << trajSize << " requested" << flush;
+}
+
 void VisualizerCamControl::fly(bool down)
 {
   if (down) {
-    trajectory.clear();
-    double stepTimeMS = (double)(ui->sbStepTime->value());
-    double totalTimeMS = (double)(ui->dsbDuration->value())*1000.0;
-    unsigned int trajSize = totalTimeMS/stepTimeMS;
-    unsigned int startIdx = 0;
-    if (ui->rbStartCurrent->isChecked())  startIdx = ui->hsStorage->value();
-    if (ui->rbStartFirst->isChecked())  startIdx = 1;
-    if (ui->rbStartLast->isChecked()) startIdx = ui->hsStorage->maximum();
-    if (ui->rbStartSpecific->isChecked()) startIdx = ui->sbStart->value();
-    unsigned int endIdx = 0;
-    if (ui->rbStopCurrent->isChecked())  endIdx = ui->hsStorage->value();
-    if (ui->rbStopFirst->isChecked())  endIdx = 1;
-    if (ui->rbStopLast->isChecked()) endIdx = ui->hsStorage->maximum();
-    if (ui->rbStopSpecific->isChecked()) endIdx = ui->sbStop->value();
-    // generate trajectory dependent on selected method
-    if (ui->rbInterpolLinear->isChecked())
-      generateLinearTrajectory(startIdx-1, endIdx-1, trajSize);
-    if (ui->rbInterpolSpline->isChecked())
-      generateSplineTrajectory(startIdx-1, endIdx-1, trajSize);
-    //cout << endl << "generated trajectory with " << trajectory.size() << " elements, " << trajSize << " requested" << flush;
+    generateTrajectory();
     // start pilot
     trajectoryIdx = 0;
-    pilot->start(stepTimeMS); // even works when trajectory is empty
+    pilot->start(ui->sbStepTime->value()); // even works when trajectory is empty
     cout << endl << "pilot takes off" << flush;
   } else {
     pilot->stop();
@@ -270,6 +277,46 @@ void VisualizerCamControl::fly(bool down)
   }
 }
 
+void VisualizerCamControl::renderFlight()
+{
+  if (camPositions.empty())
+    return;
+  ui->pbFly->setChecked(false);
+  generateTrajectory();
+  renderTrajectory();
+}
+
+unsigned int VisualizerCamControl::renderFlight(unsigned int startIdx, unsigned int endIdx, unsigned int nbFrames, bool spline)
+{
+  if ((startIdx == endIdx) || (startIdx >= camPositions.size()) || (endIdx >= camPositions.size()))
+    throw range_error("VisualizerCamControl::renderFlight: invalid start or end position");
+  if (nbFrames < 2)
+    throw range_error("VisualizerCamControl::renderFlight: at least 2 frames are needed");
+  if (spline)
+    generateSplineTrajectory(startIdx, endIdx, nbFrames);
+  else
+    generateLinearTrajectory(startIdx, endIdx, nbFrames);
+  return renderTrajectory();
+}
+
+unsigned int VisualizerCamControl::renderTrajectory()
+{
+  cout << endl << "rendering " << trajectory.size() << " frames..." << flush;
+  unsigned int nbRendered = 0;
+  BOOST_FOREACH(const CamPos &campos, trajectory) {
+    mMav.setCameraPos(campos[0], campos[1], campos[2], campos[3], campos[4], campos[5]);
+    if (!mMav.renderFrameToSink()) {
+      cout << endl << "WARNING: offscreen rendering failed" << flush;
+      break;
+    }
+    ++nbRendered;
+  }
+  mMav.endFrameSequence();
+  cout << "done" << flush;
+  update3D(); // show last pose on screen
+  return nbRendered;
+}
+
 void VisualizerCamControl::flyToNextPos()
 {
   if (trajectoryIdx >= trajectory.size()) {
@@ -288,6 +335,11 @@ void VisualizerCamControl::flyToNextPos()
 
 void VisualizerCamControl::generateLinearTrajectory(unsigned int startIdx, unsigned int endIdx, unsigned int nbTarget)
 {
+  if (startIdx > endIdx) { // backwards: the same poses in reverse order
+    generateLinearTrajectory(endIdx, startIdx, nbTarget);
+    reverse(trajectory.begin(), trajectory.end());
+    return;
+  }
   unsigned int nbGiven = endIdx-startIdx+1;
   unsigned int nbIntervals = nbGiven - 1;
   unsigned int nbSubintervalsPerInterval = (nbTarget-1)/(nbIntervals); // -1 due to additional end pose
@@ -316,6 +368,11 @@ double at(vector<Spline> &splines, unsigned int d, double s) {
 };
 void VisualizerCamControl::generateSplineTrajectory(unsigned int startIdx, unsigned int endIdx, unsigned int nbTarget)
 {
+  if (startIdx > endIdx) { // backwards: the same poses in reverse order
+    generateSplineTrajectory(endIdx, startIdx, nbTarget);
+    reverse(trajectory.begin(), trajectory.end());
+    return;
+  }
   const unsigned int nbSubintervalsPerInterval = 10;
   const double offset = ui->dsbFixedWeight->value();
   double weights[] = {1.0, 1.0, 0.7, 3.0, 3.0, 3.0}; //pan-tilt-range-x-y-z
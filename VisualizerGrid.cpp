@@ -20,38 +20,130 @@
  *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "Gui3DQt/VisualizerGrid.hpp"
-#include "Gui3DQt/graphics.hpp"
+#include "Gui3DQt/GLState.hpp"
 
 #include <cmath>
+#include <vector>
+#include <GL/glu.h>
 
 #define _USE_MATH_DEFINES
 #include <math.h>
 
+#define GRID_FINE_LINES     100 // number of lines in each direction from the center, fine level
+#define GRID_COARSE_LINES   50 // coarse level, has 10x the spacing and thus covers 5x the fine extent
+#define GRID_HEIGHT_FACTOR  0.1 // fine spacing relative to the camera height (rounded down to a power of 10)
+#define GRID_MIN_SPACING    0.001
+
 namespace Gui3DQt {
   
 VisualizerGrid::VisualizerGrid(QWidget *parent)
     : Visualizer(parent), x(0), y(0), z(0), yawRad(0)
+    , gridMesh(QGLBuffer::VertexBuffer)
 {
+  frame.add(0, 0, 0, 0, 0, 0);
 }
 
 VisualizerGrid::VisualizerGrid(double x_, double y_, double z_, double yawRad_, QWidget *parent)
     : Visualizer(parent), x(x_), y(y_), z(z_), yawRad(yawRad_)
+    , gridMesh(QGLBuffer::VertexBuffer)
 {
+  frame.add(0, 0, 0, 0, 0, 0);
 }
 
 VisualizerGrid::~VisualizerGrid()
 {
+  gridMesh.destroy();
+}
 
+// adds lines at integer positions -n..n in both directions
+static void add_unit_grid(std::vector<GLfloat> &mesh, int n)
+{
+  for (int i = -n; i <= n; i++) {
+    GLfloat l[8] = {(GLfloat)i, (GLfloat)-n, (GLfloat)i, (GLfloat)n, (GLfloat)-n, (GLfloat)i, (GLfloat)n, (GLfloat)i};
+    mesh.insert(mesh.end(), l, l+8);
+  }
 }
 
+void VisualizerGrid::initGL()
+{
+  std::vector<GLfloat> mesh;
+  add_unit_grid(mesh, GRID_FINE_LINES);
+  add_unit_grid(mesh, GRID_COARSE_LINES);
+  if (gridMesh.create()) {
+    gridMesh.setUsagePattern(QGLBuffer::StaticDraw);
+    gridMesh.bind();
+    gridMesh.allocate(&mesh[0], mesh.size()*sizeof(GLfloat));
+    gridMesh.release();
+  }
+}
 
 void VisualizerGrid::paintGLOpaque()
 {
+  if (!gridMesh.isCreated())
+    initGL();
+
   glPushMatrix();
   glTranslatef(x, y, z);
   glRotatef(yawRad/M_PI*180,0,0,1); // angle(DEG), x, y, z (rotation axis)
-  Graphics::draw_grid(0,0);
-  Graphics::draw_coordinate_frame(1.0);
+
+  // view center and viewing distance in grid coordinates
+  GLdouble view[16], m[16], p[16];
+  GLint vp[4];
+  GLState &state = GLState::current();
+  state.getViewMatrix(view);
+  state.getProjectionMatrix(p);
+  state.getViewport(vp);
+  const double c = cos(yawRad), s = sin(yawRad);
+  const GLdouble grid[16] = {c, s, 0, 0,  -s, c, 0, 0,  0, 0, 1, 0,  x, y, z, 1}; // as set above
+  for (int col=0; col<4; ++col)
+    for (int row=0; row<4; ++row)
+      m[4*col+row] = view[row]*grid[4*col] + view[4+row]*grid[4*col+1] + view[8+row]*grid[4*col+2] + view[12+row]*grid[4*col+3];
+  double camX, camY, camZ, height;
+  if (p[11] == 0) { // orthographic (2D mode): center of the viewport, visible height
+    gluUnProject(vp[0] + 0.5*vp[2], vp[1] + 0.5*vp[3], 0, m, p, vp, &camX, &camY, &camZ);
+    height = vp[3] / std::max(sqrt(m[0]*m[0] + m[1]*m[1]), 1e-9);
+  } else { // perspective: camera position -R^T*t of the modelview matrix, height above the plane
+    camX = -(m[0]*m[12] + m[1]*m[13] + m[2]*m[14]);
+    camY = -(m[4]*m[12] + m[5]*m[13] + m[6]*m[14]);
+    camZ = -(m[8]*m[12] + m[9]*m[13] + m[10]*m[14]);
+    height = fabs(camZ);
+  }
+
+  // fine lines fade out until the coarse spacing becomes the fine one
+  double level = log10(std::max(height*GRID_HEIGHT_FACTOR, GRID_MIN_SPACING));
+  double spacing = pow(10.0, floor(level));
+  double fade = 1.0 - (level - floor(level));
+  double coarse = 10*spacing;
+  double centerX = floor(camX/coarse + 0.5)*coarse; // snapped, so lines do not move with the camera
+  double centerY = floor(camY/coarse + 0.5)*coarse;
+
+  if (gridMesh.isCreated()) {
+    const int nbFine = 4*(2*GRID_FINE_LINES+1);
+    const int nbCoarse = 4*(2*GRID_COARSE_LINES+1);
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_LINE_BIT | GL_CURRENT_BIT);
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glDisable(GL_LIGHTING);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glLineWidth(0.5);
+    gridMesh.bind();
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, 0);
+    gridMesh.release();
+    glPushMatrix();
+    glTranslated(centerX, centerY, 0);
+    glScaled(spacing, spacing, 1);
+    glColor4f(0.4, 0.4, 0.4, fade);
+    glDrawArrays(GL_LINES, 0, nbFine);
+    glScaled(10, 10, 1);
+    glColor4f(0.4, 0.4, 0.4, 1);
+    glDrawArrays(GL_LINES, nbFine, nbCoarse);
+    glPopMatrix();
+    glPopClientAttrib();
+    glPopAttrib();
+  }
+
+  frame.render();
   glPopMatrix();
 }
 
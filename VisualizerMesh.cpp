@@ -0,0 +1,271 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Gui3DQt/VisualizerMesh.hpp"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdexcept>
+#include <QtOpenGL/QGLBuffer>
+
+using namespace std;
+
+namespace Gui3DQt {
+
+struct VisualizerMesh::GpuSubmesh {
+  struct Vertex {
+    GLfloat x, y, z;
+    GLfloat nx, ny, nz;
+    GLubyte r, g, b, a;
+  };
+  GpuSubmesh() : vertexBuffer(QGLBuffer::VertexBuffer), indexBuffer(QGLBuffer::IndexBuffer), nbIndices(0), hasNormals(false), hasColors(false) {}
+  ~GpuSubmesh() { vertexBuffer.destroy(); indexBuffer.destroy(); }
+  QGLBuffer vertexBuffer;
+  QGLBuffer indexBuffer;
+  GLsizei   nbIndices;
+  bool      hasNormals;
+  bool      hasColors;
+};
+
+void VisualizerMesh::Submesh::computeNormals()
+{
+  normals.assign(vertices.size(), 0);
+  for (size_t t = 0; t+2 < indices.size(); t += 3) {
+    const GLfloat *a = &vertices[3*indices[t]];
+    const GLfloat *b = &vertices[3*indices[t+1]];
+    const GLfloat *c = &vertices[3*indices[t+2]];
+    const GLfloat u[3] = {b[0]-a[0], b[1]-a[1], b[2]-a[2]};
+    const GLfloat v[3] = {c[0]-a[0], c[1]-a[1], c[2]-a[2]};
+    const GLfloat n[3] = {u[1]*v[2]-u[2]*v[1], u[2]*v[0]-u[0]*v[2], u[0]*v[1]-u[1]*v[0]}; // length is twice the area
+    for (int k = 0; k < 3; ++k)
+      for (int i = 0; i < 3; ++i)
+        normals[3*indices[t+k]+i] += n[i];
+  }
+  for (size_t i = 0; i+2 < normals.size(); i += 3) {
+    GLfloat len = sqrt(normals[i]*normals[i] + normals[i+1]*normals[i+1] + normals[i+2]*normals[i+2]);
+    if (len > 0) {
+      normals[i] /= len;
+      normals[i+1] /= len;
+      normals[i+2] /= len;
+    }
+  }
+}
+
+VisualizerMesh::VisualizerMesh(QWidget *parent)
+  : Visualizer(parent), clearAll(false), nbPendingTriangles(0), nbUploadedTriangles(0), lighting(true)
+{
+  setColor(0.7, 0.7, 0.7);
+}
+
+VisualizerMesh::~VisualizerMesh()
+{
+  for (map<int, Submesh*>::iterator p = pending.begin(); p != pending.end(); ++p)
+    delete p->second;
+  for (map<int, GpuSubmesh*>::iterator s = submeshes.begin(); s != submeshes.end(); ++s)
+    delete s->second;
+}
+
+void VisualizerMesh::setSubmesh(int id, Submesh &mesh)
+{
+  const size_t nbVertices = mesh.vertices.size()/3;
+  for (size_t i = 0; i < mesh.indices.size(); ++i)
+    if (mesh.indices[i] >= nbVertices)
+      throw invalid_argument("VisualizerMesh: vertex index out of range");
+  Submesh *data = new Submesh();
+  data->vertices.swap(mesh.vertices);
+  data->normals.swap(mesh.normals);
+  data->colors.swap(mesh.colors);
+  data->indices.swap(mesh.indices);
+  mesh = Submesh();
+  boost::mutex::scoped_lock lock(mutex);
+  Submesh *&entry = pending[id];
+  if (entry)
+    nbPendingTriangles -= entry->indices.size()/3;
+  delete entry; // replaced before it was uploaded
+  entry = data;
+  nbPendingTriangles += data->indices.size()/3;
+}
+
+void VisualizerMesh::removeSubmesh(int id)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  Submesh *&entry = pending[id];
+  if (entry)
+    nbPendingTriangles -= entry->indices.size()/3;
+  delete entry;
+  entry = NULL;
+}
+
+void VisualizerMesh::clear()
+{
+  boost::mutex::scoped_lock lock(mutex);
+  for (map<int, Submesh*>::iterator p = pending.begin(); p != pending.end(); ++p) {
+    if (p->second)
+      nbPendingTriangles -= p->second->indices.size()/3;
+    delete p->second;
+  }
+  pending.clear();
+  clearAll = true; // the uploaded sub-meshes are only known to the paint thread
+}
+
+void VisualizerMesh::setColor(float r, float g, float b)
+{
+  color[0] = r;
+  color[1] = g;
+  color[2] = b;
+}
+
+void VisualizerMesh::setLighting(bool enable)
+{
+  lighting = enable;
+}
+
+size_t VisualizerMesh::nbTriangles() const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return nbUploadedTriangles + nbPendingTriangles;
+}
+
+void VisualizerMesh::commit()
+{
+  emit stateChanged();
+}
+
+void VisualizerMesh::upload()
+{
+  map<int, Submesh*> changes;
+  size_t nbChangedTriangles;
+  bool removeAll;
+  {
+    boost::mutex::scoped_lock lock(mutex);
+    changes.swap(pending);
+    nbChangedTriangles = nbPendingTriangles; // still counted as pending until they are uploaded
+    removeAll = clearAll;
+    clearAll = false;
+  }
+  size_t nbUploaded = nbUploadedTriangles; // only written by this thread
+  if (removeAll) {
+    for (map<int, GpuSubmesh*>::iterator s = submeshes.begin(); s != submeshes.end(); ++s)
+      delete s->second;
+    submeshes.clear();
+    nbUploaded = 0;
+  }
+  for (map<int, Submesh*>::iterator c = changes.begin(); c != changes.end(); ++c) {
+    map<int, GpuSubmesh*>::iterator s = submeshes.find(c->first);
+    if (s != submeshes.end()) {
+      nbUploaded -= s->second->nbIndices/3;
+      if (!c->second || c->second->indices.empty()) {
+        delete s->second;
+        submeshes.erase(s);
+      }
+    }
+    Submesh *data = c->second;
+    if (!data || data->indices.empty()) {
+      delete data;
+      continue;
+    }
+    GpuSubmesh *gpu = (s != submeshes.end()) ? s->second : (submeshes[c->first] = new GpuSubmesh());
+    const size_t nbVertices = data->vertices.size()/3;
+    gpu->hasNormals = (data->normals.size() == 3*nbVertices);
+    gpu->hasColors = (data->colors.size() == 3*nbVertices);
+    vector<GpuSubmesh::Vertex> vertices(nbVertices);
+    for (size_t i = 0; i < nbVertices; ++i) {
+      GpuSubmesh::Vertex &v = vertices[i];
+      v.x = data->vertices[3*i]; v.y = data->vertices[3*i+1]; v.z = data->vertices[3*i+2];
+      if (gpu->hasNormals) {
+        v.nx = data->normals[3*i]; v.ny = data->normals[3*i+1]; v.nz = data->normals[3*i+2];
+      } else {
+        v.nx = v.ny = 0; v.nz = 1;
+      }
+      if (gpu->hasColors) {
+        v.r = data->colors[3*i]; v.g = data->colors[3*i+1]; v.b = data->colors[3*i+2];
+      } else {
+        v.r = v.g = v.b = 255;
+      }
+      v.a = 255;
+    }
+    if (!gpu->vertexBuffer.isCreated()) {
+      gpu->vertexBuffer.create();
+      gpu->vertexBuffer.setUsagePattern(QGLBuffer::StaticDraw);
+      gpu->indexBuffer.create();
+      gpu->indexBuffer.setUsagePattern(QGLBuffer::StaticDraw);
+    }
+    gpu->vertexBuffer.bind();
+    gpu->vertexBuffer.allocate(&vertices[0], vertices.size()*sizeof(GpuSubmesh::Vertex));
+    gpu->vertexBuffer.release();
+    gpu->indexBuffer.bind();
+    gpu->indexBuffer.allocate(&data->indices[0], data->indices.size()*sizeof(GLuint));
+    gpu->indexBuffer.release();
+    gpu->nbIndices = data->indices.size();
+    nbUploaded += gpu->nbIndices/3;
+    delete data;
+  }
+  boost::mutex::scoped_lock lock(mutex);
+  nbPendingTriangles -= nbChangedTriangles;
+  nbUploadedTriangles = nbUploaded;
+}
+
+void VisualizerMesh::paintGLOpaque()
+{
+  upload();
+  if (submeshes.empty())
+    return;
+  glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_LIGHTING_BIT);
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+  glEnable(GL_COLOR_MATERIAL);
+  glEnable(GL_NORMALIZE);
+  glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE); // reconstructed surfaces are often not closed
+  const GLsizei stride = sizeof(GpuSubmesh::Vertex);
+  for (map<int, GpuSubmesh*>::const_iterator s = submeshes.begin(); s != submeshes.end(); ++s) {
+    GpuSubmesh &gpu = *s->second;
+    if (lighting && gpu.hasNormals) {
+      glEnable(GL_LIGHTING);
+      glEnableClientState(GL_NORMAL_ARRAY);
+    } else {
+      glDisable(GL_LIGHTING);
+      glDisableClientState(GL_NORMAL_ARRAY);
+    }
+    if (gpu.hasColors) {
+      glEnableClientState(GL_COLOR_ARRAY);
+    } else {
+      glDisableClientState(GL_COLOR_ARRAY);
+      glColor3fv(color);
+    }
+    gpu.vertexBuffer.bind();
+    glVertexPointer(3, GL_FLOAT, stride, (const GLvoid*)offsetof(GpuSubmesh::Vertex, x));
+    glNormalPointer(GL_FLOAT, stride, (const GLvoid*)offsetof(GpuSubmesh::Vertex, nx));
+    glColorPointer(4, GL_UNSIGNED_BYTE, stride, (const GLvoid*)offsetof(GpuSubmesh::Vertex, r));
+    gpu.vertexBuffer.release();
+    gpu.indexBuffer.bind();
+    glDrawElements(GL_TRIANGLES, gpu.nbIndices, GL_UNSIGNED_INT, 0);
+    gpu.indexBuffer.release();
+  }
+  glPopClientAttrib();
+  glPopAttrib();
+}
+
+void VisualizerMesh::paintGLTranslucent()
+{
+}
+
+} // namespace
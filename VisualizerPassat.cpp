@@ -25,6 +25,7 @@
 #include <cmath>
 
 #include "Gui3DQt/passatmodel.hpp"
+#include "Gui3DQt/ModelAssets.hpp"
 #include "ui_VisualizerPassat.h"
 
 using namespace std;
@@ -53,8 +54,10 @@ VisualizerPassat::VisualizerPassat(double r, double g, double b, unsigned int mo
   , yawRAD(0)
   , veloAngleDEG(0)
   , wheelAngleDEG(0)
+  , lod(0)
 {
   PassatModel::setColor(modelindex, r, g, b);
+  ModelAssets::instance().preload(); // the models are prepared in the background while the Gui is set up
   
   veloTurner.setSingleShot(false);
   connect(&veloTurner, SIGNAL(timeout()), this, SLOT(timerAction()) );
@@ -79,12 +82,18 @@ void VisualizerPassat::paintGLOpaque()
   glPushMatrix();
   glTranslatef(x, y, z);
   glRotatef(yawRAD/M_PI*180,0,0,1); // angle(DEG), x, y, z (rotation axis)
-  PassatModel::draw(modelindex, wheelAngleDEG/180*M_PI, veloAngleDEG/180*M_PI);
+  lod = PassatModel::levelOfDetail(x, y, z);
+  PassatModel::draw(modelindex, wheelAngleDEG/180*M_PI, veloAngleDEG/180*M_PI, PassatModel::OPAQUE_PARTS, lod);
   glPopMatrix();
 }
 
 void VisualizerPassat::paintGLTranslucent()
 {
+  glPushMatrix();
+  glTranslatef(x, y, z);
+  glRotatef(yawRAD/M_PI*180,0,0,1); // angle(DEG), x, y, z (rotation axis)
+  PassatModel::draw(modelindex, wheelAngleDEG/180*M_PI, veloAngleDEG/180*M_PI, PassatModel::TRANSLUCENT_PARTS, lod);
+  glPopMatrix();
 }
 
 void VisualizerPassat::setPose(double newx, double newy, double newz, double newyawRAD)
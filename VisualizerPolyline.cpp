@@ -0,0 +1,258 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Gui3DQt/VisualizerPolyline.hpp"
+#include "Gui3DQt/GLState.hpp"
+
+#include <math.h>
+#include <algorithm>
+
+#define BASE_TOLERANCE  0.05 // m, of level 1, each further level has 4 times the tolerance
+#define MIN_CAPACITY    1024 // points
+
+using namespace std;
+
+namespace Gui3DQt {
+
+static inline double level_tolerance(int level)
+{
+  return BASE_TOLERANCE * pow(4.0, level-1);
+}
+
+VisualizerPolyline::VisualizerPolyline(QWidget *parent)
+  : Visualizer(parent), tolerance(0)
+{
+}
+
+VisualizerPolyline::~VisualizerPolyline()
+{
+  for (size_t i = 0; i < tracks.size(); ++i)
+    delete tracks[i];
+}
+
+int VisualizerPolyline::addTrack(float r, float g, float b, float lineWidth)
+{
+  Track *track = new Track();
+  track->color[0] = r;
+  track->color[1] = g;
+  track->color[2] = b;
+  track->lineWidth = lineWidth;
+  boost::mutex::scoped_lock lock(mutex);
+  tracks.push_back(track);
+  return tracks.size()-1;
+}
+
+void VisualizerPolyline::appendPoint(int trackId, double x, double y, double z)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  Track &track = *tracks.at(trackId);
+  const GLfloat p[3] = {(GLfloat)x, (GLfloat)y, (GLfloat)z};
+  const GLuint index = track.points.size()/3;
+  if (index % SEGMENT_POINTS == 0) {
+    Segment segment;
+    copy(p, p+3, segment.min);
+    copy(p, p+3, segment.max);
+    segment.first[0] = index;
+    for (int l = 1; l < NB_LEVELS; ++l)
+      segment.first[l] = track.levels[l].indices.size();
+    track.segments.push_back(segment);
+  }
+  Segment &segment = track.segments.back();
+  for (int i = 0; i < 3; ++i) {
+    segment.min[i] = min(segment.min[i], p[i]);
+    segment.max[i] = max(segment.max[i], p[i]);
+  }
+  track.points.insert(track.points.end(), p, p+3);
+  for (int l = 1; l < NB_LEVELS; ++l) { // radial distance decimation, incremental
+    vector<GLuint> &indices = track.levels[l].indices;
+    if (!indices.empty()) {
+      const GLfloat *last = &track.points[3*indices.back()];
+      const double dx = p[0]-last[0], dy = p[1]-last[1], dz = p[2]-last[2];
+      const double tol = level_tolerance(l);
+      if (dx*dx + dy*dy + dz*dz < tol*tol)
+        continue;
+    }
+    indices.push_back(index);
+  }
+}
+
+void VisualizerPolyline::clearTrack(int trackId)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  Track &track = *tracks.at(trackId);
+  track.points.clear();
+  track.segments.clear();
+  track.uploaded = 0; // buffers are reused
+  for (int l = 1; l < NB_LEVELS; ++l) {
+    track.levels[l].indices.clear();
+    track.levels[l].uploaded = 0;
+  }
+}
+
+void VisualizerPolyline::setTrackVisible(int trackId, bool visible)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  tracks.at(trackId)->visible = visible;
+}
+
+size_t VisualizerPolyline::nbPoints(int trackId) const
+{
+  boost::mutex::scoped_lock lock(mutex);
+  return tracks.at(trackId)->points.size()/3;
+}
+
+void VisualizerPolyline::setTolerance(double pixels)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  tolerance = pixels;
+}
+
+void VisualizerPolyline::commit()
+{
+  emit stateChanged();
+}
+
+// copies the new elements of data into buffer, doubling its capacity if necessary
+template <class T>
+static void append_to_buffer(QGLBuffer &buffer, GLsizei &capacity, GLsizei &uploaded, const vector<T> &data, int tupleSize)
+{
+  const GLsizei size = data.size()/tupleSize;
+  if (uploaded == size)
+    return;
+  if (!buffer.isCreated()) {
+    if (!buffer.create())
+      return;
+    buffer.setUsagePattern(QGLBuffer::DynamicDraw);
+  }
+  buffer.bind();
+  if (size > capacity) { // grow: the history has to be uploaded again
+    capacity = max(max(2*capacity, size), (GLsizei)MIN_CAPACITY);
+    buffer.allocate(capacity*tupleSize*sizeof(T));
+    uploaded = 0;
+  }
+  buffer.write(uploaded*tupleSize*sizeof(T), &data[uploaded*tupleSize], (size-uploaded)*tupleSize*sizeof(T));
+  buffer.release();
+  uploaded = size;
+}
+
+void VisualizerPolyline::upload(Track &track)
+{
+  append_to_buffer(track.buffer, track.capacity, track.uploaded, track.points, 3);
+  if (tolerance > 0)
+    for (int l = 1; l < NB_LEVELS; ++l)
+      append_to_buffer(track.levels[l].buffer, track.levels[l].capacity, track.levels[l].uploaded, track.levels[l].indices, 1);
+}
+
+int VisualizerPolyline::selectLevel(const Segment &segment, const GLdouble *m, const GLdouble *p, const GLint *vp) const
+{
+  // size of a pixel at the part of the segment closest to the camera
+  double pixelSize;
+  if (p[11] == 0) { // orthographic (2D mode), modelview may contain a scaling
+    pixelSize = 2.0 / (p[5] * vp[3] * max(sqrt(m[0]*m[0] + m[1]*m[1]), 1e-9));
+  } else {
+    const double cam[3] = {-(m[0]*m[12] + m[1]*m[13] + m[2]*m[14]),
+                           -(m[4]*m[12] + m[5]*m[13] + m[6]*m[14]),
+                           -(m[8]*m[12] + m[9]*m[13] + m[10]*m[14])};
+    double dist2 = 0;
+    for (int i = 0; i < 3; ++i) {
+      double d = max(max(segment.min[i] - cam[i], cam[i] - segment.max[i]), 0.0);
+      dist2 += d*d;
+    }
+    pixelSize = 2.0 * sqrt(dist2) / (p[5] * vp[3]);
+  }
+  const double maxError = tolerance * pixelSize;
+  int level = 0;
+  while ((level+1 < NB_LEVELS) && (level_tolerance(level+1) <= maxError))
+    ++level;
+  return level;
+}
+
+void VisualizerPolyline::draw(Track &track, const GLdouble *modelview, const GLdouble *projection, const GLint *viewport)
+{
+  const GLsizei nbPoints = track.uploaded;
+  glColor3fv(track.color);
+  glLineWidth(track.lineWidth);
+  track.buffer.bind();
+  glVertexPointer(3, GL_FLOAT, 0, 0);
+  track.buffer.release();
+  for (size_t s = 0; s < track.segments.size(); ++s) {
+    const Segment &segment = track.segments[s];
+    const GLint start = segment.first[0];
+    if (start >= nbPoints-1)
+      break;
+    const GLint end = min(start + SEGMENT_POINTS, nbPoints-1); // first point of the next segment, connects both
+    const int level = (tolerance > 0) ? selectLevel(segment, modelview, projection, viewport) : 0;
+    Level &l = track.levels[level];
+    if ((level == 0) || (l.uploaded == 0)) {
+      glDrawArrays(GL_LINE_STRIP, start, end-start+1);
+      continue;
+    }
+    // kept points of this segment, plus the next kept point to connect to the following segments
+    const GLsizei first = min(segment.first[level], l.uploaded);
+    const GLsizei next = (s+1 < track.segments.size()) ? min(track.segments[s+1].first[level], l.uploaded) : l.uploaded;
+    const GLsizei count = next - first + ((next < l.uploaded) ? 1 : 0);
+    if (count > 1) {
+      l.buffer.bind();
+      glDrawElements(GL_LINE_STRIP, count, GL_UNSIGNED_INT, (const GLvoid*)(first*sizeof(GLuint)));
+      l.buffer.release();
+    }
+    if (next == l.uploaded) {
+      // the points after the last kept one are all within the tolerance, draw them to connect to the current end
+      const GLint lastKept = (next > first) ? (GLint)l.indices[next-1] : start;
+      if (lastKept < end)
+        glDrawArrays(GL_LINE_STRIP, lastKept, end-lastKept+1);
+    }
+  }
+}
+
+void VisualizerPolyline::paintGLOpaque()
+{
+  GLdouble modelview[16], projection[16];
+  GLint viewport[4];
+  GLState &state = GLState::current();
+  state.getViewMatrix(modelview);
+  state.getProjectionMatrix(projection);
+  state.getViewport(viewport);
+
+  glPushAttrib(GL_ENABLE_BIT | GL_LINE_BIT | GL_CURRENT_BIT);
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+  glDisable(GL_LIGHTING);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  boost::mutex::scoped_lock lock(mutex);
+  for (size_t i = 0; i < tracks.size(); ++i) {
+    Track &track = *tracks[i];
+    if (!track.visible || track.points.empty())
+      continue;
+    upload(track);
+    if (track.uploaded < 2)
+      continue;
+    draw(track, modelview, projection, viewport);
+  }
+  lock.unlock();
+  glPopClientAttrib();
+  glPopAttrib();
+}
+
+void VisualizerPolyline::paintGLTranslucent()
+{
+}
+
+} // namespace
@@ -0,0 +1,367 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Gui3DQt/VisualizerVoxelMap.hpp"
+
+#include <string.h>
+#include <stddef.h>
+#include <GL/gl.h>
+#include <QtOpenGL/QGLBuffer>
+#include <boost/bind.hpp>
+
+#define CHUNK_BITS    5
+#define CHUNK_SIZE    (1 << CHUNK_BITS) // voxels per chunk and axis
+#define PADDED_SIZE   (CHUNK_SIZE + 2) // with the neighboring voxels around the chunk
+#define MESH_THREADS  2 // in addition to the thread calling prepare(), which runs concurrently with other visualizers
+
+using namespace std;
+
+namespace Gui3DQt {
+
+struct VisualizerVoxelMap::ChunkData {
+  ChunkData() : nbOccupied(0) { memset(voxels, 0, sizeof(voxels)); }
+  unsigned char voxels[CHUNK_SIZE*CHUNK_SIZE*CHUNK_SIZE]; // x runs fastest
+  int nbOccupied;
+};
+
+struct VisualizerVoxelMap::ChunkMesh {
+  struct Vertex {
+    GLfloat x, y, z;
+    GLubyte r, g, b, a;
+  };
+  ChunkMesh() : buffer(QGLBuffer::VertexBuffer), nbVertices(0), uploaded(true) {}
+  ~ChunkMesh() { buffer.destroy(); }
+  std::vector<Vertex> vertices; // GL_QUADS, cleared after the upload
+  QGLBuffer buffer;
+  GLsizei   nbVertices; // in the buffer
+  bool      uploaded;
+};
+
+// input and output of meshing one chunk in a worker thread
+struct VisualizerVoxelMap::MeshJob {
+  unsigned char voxels[PADDED_SIZE*PADDED_SIZE*PADDED_SIZE]; // copy of the chunk and its border
+  unsigned char palette[256][3];
+  double origin[3]; // metric position of the first voxel
+  double voxelSize;
+  ChunkMesh *mesh;
+};
+
+static inline int chunk_coord(int i) // floor division, also for negative indices
+{
+  return (i >= 0) ? (i >> CHUNK_BITS) : -((-i - 1) >> CHUNK_BITS) - 1;
+}
+
+static inline int chunk_index(int lx, int ly, int lz)
+{
+  return (lz*CHUNK_SIZE + ly)*CHUNK_SIZE + lx;
+}
+
+static inline int padded_index(int lx, int ly, int lz) // -1..CHUNK_SIZE
+{
+  return ((lz+1)*PADDED_SIZE + (ly+1))*PADDED_SIZE + (lx+1);
+}
+
+VisualizerVoxelMap::VisualizerVoxelMap(double voxelSize_, QWidget *parent)
+  : Visualizer(parent), voxelSize(voxelSize_), workers(MESH_THREADS)
+{
+  for (int v = 0; v < 256; ++v) {
+    int r,g,b;
+    HSV2RGB(240 - 240*(v-1)/254, 255, 230, r, g, b); // blue .. red
+    palette[v][0] = r; palette[v][1] = g; palette[v][2] = b;
+  }
+}
+
+VisualizerVoxelMap::~VisualizerVoxelMap()
+{
+  for (map<ChunkKey, ChunkData*>::iterator c = chunks.begin(); c != chunks.end(); ++c)
+    delete c->second;
+  for (map<ChunkKey, ChunkMesh*>::iterator m = meshes.begin(); m != meshes.end(); ++m)
+    delete m->second;
+}
+
+double VisualizerVoxelMap::getVoxelSize() const
+{
+  return voxelSize;
+}
+
+void VisualizerVoxelMap::markDirty(const ChunkKey &key, int lx, int ly, int lz)
+{
+  dirtyChunks.insert(key);
+  const int l[3] = {lx, ly, lz};
+  for (int d = 0; d < 3; ++d) { // faces of the neighbor may become hidden or visible
+    ChunkKey n = key;
+    int *c = (d == 0) ? &n.x : ((d == 1) ? &n.y : &n.z);
+    if (l[d] == 0) {
+      --(*c);
+      dirtyChunks.insert(n);
+    } else if (l[d] == CHUNK_SIZE-1) {
+      ++(*c);
+      dirtyChunks.insert(n);
+    }
+  }
+}
+
+void VisualizerVoxelMap::setVoxel(int ix, int iy, int iz, unsigned char value)
+{
+  ChunkKey key = {chunk_coord(ix), chunk_coord(iy), chunk_coord(iz)};
+  const int lx = ix - key.x*CHUNK_SIZE, ly = iy - key.y*CHUNK_SIZE, lz = iz - key.z*CHUNK_SIZE;
+  boost::mutex::scoped_lock lock(mutex);
+  map<ChunkKey, ChunkData*>::iterator c = chunks.find(key);
+  if (c == chunks.end()) {
+    if (value == 0)
+      return;
+    c = chunks.insert(make_pair(key, new ChunkData())).first;
+  }
+  unsigned char &voxel = c->second->voxels[chunk_index(lx, ly, lz)];
+  if (voxel == value)
+    return;
+  c->second->nbOccupied += (value != 0) - (voxel != 0);
+  voxel = value;
+  markDirty(key, lx, ly, lz);
+  if (c->second->nbOccupied == 0) {
+    delete c->second;
+    chunks.erase(c);
+  }
+}
+
+void VisualizerVoxelMap::setVoxelAt(double x, double y, double z, unsigned char value)
+{
+  setVoxel((int)floor(x/voxelSize), (int)floor(y/voxelSize), (int)floor(z/voxelSize), value);
+}
+
+unsigned char VisualizerVoxelMap::getVoxel(int ix, int iy, int iz) const
+{
+  ChunkKey key = {chunk_coord(ix), chunk_coord(iy), chunk_coord(iz)};
+  boost::mutex::scoped_lock lock(mutex);
+  map<ChunkKey, ChunkData*>::const_iterator c = chunks.find(key);
+  if (c == chunks.end())
+    return 0;
+  return c->second->voxels[chunk_index(ix - key.x*CHUNK_SIZE, iy - key.y*CHUNK_SIZE, iz - key.z*CHUNK_SIZE)];
+}
+
+void VisualizerVoxelMap::clear()
+{
+  boost::mutex::scoped_lock lock(mutex);
+  for (map<ChunkKey, ChunkData*>::iterator c = chunks.begin(); c != chunks.end(); ++c) {
+    dirtyChunks.insert(c->first);
+    delete c->second;
+  }
+  chunks.clear();
+}
+
+void VisualizerVoxelMap::setPaletteColor(unsigned char value, int r, int g, int b)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  palette[value][0] = r;
+  palette[value][1] = g;
+  palette[value][2] = b;
+  for (map<ChunkKey, ChunkData*>::iterator c = chunks.begin(); c != chunks.end(); ++c)
+    dirtyChunks.insert(c->first);
+}
+
+size_t VisualizerVoxelMap::nbFaces() const
+{
+  size_t n = 0;
+  for (map<ChunkKey, ChunkMesh*>::const_iterator m = meshes.begin(); m != meshes.end(); ++m)
+    n += m->second->nbVertices/4;
+  return n;
+}
+
+void VisualizerVoxelMap::commit()
+{
+  emit stateChanged();
+}
+
+void VisualizerVoxelMap::meshChunk(MeshJob *job)
+{
+  // brightness per face direction, as there is no lighting
+  static const float shade[3][2] = {{0.8f, 0.8f}, {0.65f, 0.65f}, {0.5f, 1.0f}}; // x, y, z; negative, positive
+  vector<ChunkMesh::Vertex> &vertices = job->mesh->vertices;
+  vertices.clear();
+  unsigned char mask[CHUNK_SIZE*CHUNK_SIZE];
+  for (int d = 0; d < 3; ++d) {
+    const int u = (d+1) % 3, v = (d+2) % 3;
+    for (int sign = -1; sign <= 1; sign += 2) {
+      for (int s = 0; s < CHUNK_SIZE; ++s) {
+        // faces of this slice whose neighbor in direction sign is free
+        int p[3];
+        p[d] = s;
+        for (p[v] = 0; p[v] < CHUNK_SIZE; ++p[v]) {
+          for (p[u] = 0; p[u] < CHUNK_SIZE; ++p[u]) {
+            unsigned char a = job->voxels[padded_index(p[0], p[1], p[2])];
+            int q[3] = {p[0], p[1], p[2]};
+            q[d] += sign;
+            unsigned char b = job->voxels[padded_index(q[0], q[1], q[2])];
+            mask[p[v]*CHUNK_SIZE + p[u]] = (b == 0) ? a : 0;
+          }
+        }
+        // merge equal faces into rectangles
+        for (int j = 0; j < CHUNK_SIZE; ++j) {
+          for (int i = 0; i < CHUNK_SIZE; ) {
+            const unsigned char c = mask[j*CHUNK_SIZE + i];
+            if (c == 0) {
+              ++i;
+              continue;
+            }
+            int w = 1;
+            while ((i+w < CHUNK_SIZE) && (mask[j*CHUNK_SIZE + i+w] == c))
+              ++w;
+            int h = 1;
+            for (; j+h < CHUNK_SIZE; ++h) {
+              int k = 0;
+              while ((k < w) && (mask[(j+h)*CHUNK_SIZE + i+k] == c))
+                ++k;
+              if (k < w)
+                break;
+            }
+            for (int l = 0; l < h; ++l)
+              memset(&mask[(j+l)*CHUNK_SIZE + i], 0, w);
+
+            ChunkMesh::Vertex vx;
+            const float f = shade[d][sign > 0];
+            vx.r = job->palette[c][0]*f; vx.g = job->palette[c][1]*f; vx.b = job->palette[c][2]*f; vx.a = 255;
+            const int cu[4] = {i, i+w, i+w, i};
+            const int cv[4] = {j, j, j+h, j+h};
+            for (int k = 0; k < 4; ++k) {
+              const int corner = (sign > 0) ? k : 3-k; // counter-clockwise seen from outside
+              double pos[3];
+              pos[d] = s + (sign > 0 ? 1 : 0);
+              pos[u] = cu[corner];
+              pos[v] = cv[corner];
+              vx.x = job->origin[0] + pos[0]*job->voxelSize;
+              vx.y = job->origin[1] + pos[1]*job->voxelSize;
+              vx.z = job->origin[2] + pos[2]*job->voxelSize;
+              vertices.push_back(vx);
+            }
+            i += w;
+          }
+        }
+      }
+    }
+  }
+  job->mesh->uploaded = false;
+}
+
+void VisualizerVoxelMap::prepare()
+{
+  vector<MeshJob*> jobs;
+  {
+    boost::mutex::scoped_lock lock(mutex);
+    for (set<ChunkKey>::const_iterator k = dirtyChunks.begin(); k != dirtyChunks.end(); ++k) {
+      map<ChunkKey, ChunkMesh*>::iterator m = meshes.find(*k);
+      if (m == meshes.end()) {
+        if (chunks.find(*k) == chunks.end()) // empty neighbor of a changed chunk
+          continue;
+        m = meshes.insert(make_pair(*k, new ChunkMesh())).first;
+      }
+      MeshJob *job = new MeshJob();
+      job->mesh = m->second;
+      job->voxelSize = voxelSize;
+      job->origin[0] = k->x*CHUNK_SIZE*voxelSize;
+      job->origin[1] = k->y*CHUNK_SIZE*voxelSize;
+      job->origin[2] = k->z*CHUNK_SIZE*voxelSize;
+      memcpy(job->palette, palette, sizeof(palette));
+      // copy the chunk and the adjacent layers of the 6 neighbors
+      memset(job->voxels, 0, sizeof(job->voxels));
+      map<ChunkKey, ChunkData*>::const_iterator c = chunks.find(*k);
+      if (c != chunks.end())
+        for (int z = 0; z < CHUNK_SIZE; ++z)
+          for (int y = 0; y < CHUNK_SIZE; ++y)
+            memcpy(&job->voxels[padded_index(0, y, z)], &c->second->voxels[chunk_index(0, y, z)], CHUNK_SIZE);
+      for (int d = 0; d < 3; ++d) {
+        for (int side = 0; side < 2; ++side) {
+          ChunkKey nk = *k;
+          int *nc = (d == 0) ? &nk.x : ((d == 1) ? &nk.y : &nk.z);
+          *nc += side ? 1 : -1;
+          c = chunks.find(nk);
+          if (c == chunks.end())
+            continue;
+          const int src = side ? 0 : CHUNK_SIZE-1; // layer of the neighbor
+          const int dst = side ? CHUNK_SIZE : -1; // in the padded array
+          const int u = (d+1) % 3, v = (d+2) % 3;
+          int p[3], q[3];
+          p[d] = src; q[d] = dst;
+          for (p[v] = 0; p[v] < CHUNK_SIZE; ++p[v])
+            for (p[u] = 0; p[u] < CHUNK_SIZE; ++p[u]) {
+              q[u] = p[u]; q[v] = p[v];
+              job->voxels[padded_index(q[0], q[1], q[2])] = c->second->voxels[chunk_index(p[0], p[1], p[2])];
+            }
+        }
+      }
+      jobs.push_back(job);
+    }
+    dirtyChunks.clear();
+  }
+  if (jobs.empty())
+    return;
+  vector<WorkerPool::Job> work;
+  for (size_t i = 0; i < jobs.size(); ++i)
+    work.push_back(boost::bind(&VisualizerVoxelMap::meshChunk, jobs[i]));
+  workers.run(work);
+  for (size_t i = 0; i < jobs.size(); ++i)
+    delete jobs[i];
+}
+
+void VisualizerVoxelMap::paintGLOpaque()
+{
+  glPushAttrib(GL_ENABLE_BIT | GL_POLYGON_BIT); // cull face mode
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+  glDisable(GL_LIGHTING);
+  glEnable(GL_CULL_FACE); // merged faces are closed surfaces
+  glCullFace(GL_BACK);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+  map<ChunkKey, ChunkMesh*>::iterator m = meshes.begin();
+  while (m != meshes.end()) {
+    ChunkMesh *mesh = m->second;
+    if (!mesh->uploaded) {
+      if (mesh->vertices.empty()) { // chunk became empty
+        delete mesh;
+        meshes.erase(m++);
+        continue;
+      }
+      if (!mesh->buffer.isCreated()) {
+        mesh->buffer.create();
+        mesh->buffer.setUsagePattern(QGLBuffer::StaticDraw);
+      }
+      mesh->buffer.bind();
+      mesh->buffer.allocate(&mesh->vertices[0], mesh->vertices.size()*sizeof(ChunkMesh::Vertex));
+      mesh->nbVertices = mesh->vertices.size();
+      vector<ChunkMesh::Vertex>().swap(mesh->vertices); // free the CPU copy
+      mesh->uploaded = true;
+    } else {
+      mesh->buffer.bind();
+    }
+    glVertexPointer(3, GL_FLOAT, sizeof(ChunkMesh::Vertex), (const GLvoid*)offsetof(ChunkMesh::Vertex, x));
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(ChunkMesh::Vertex), (const GLvoid*)offsetof(ChunkMesh::Vertex, r));
+    glDrawArrays(GL_QUADS, 0, mesh->nbVertices);
+    mesh->buffer.release();
+    ++m;
+  }
+  glPopClientAttrib();
+  glPopAttrib();
+}
+
+void VisualizerVoxelMap::paintGLTranslucent()
+{
+}
+
+} // namespace
@@ -0,0 +1,121 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Gui3DQt/WorkerPool.hpp"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+
+using namespace std;
+
+namespace Gui3DQt {
+
+WorkerPool::WorkerPool(unsigned int nbThreads)
+  : busyWorkers(0)
+  , stopping(false)
+{
+  nbWorkers = (nbThreads > 0) ? nbThreads : max(1u, boost::thread::hardware_concurrency());
+  for (unsigned int i=0; i<nbWorkers; ++i)
+    workers.create_thread(boost::bind(&WorkerPool::work, this));
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    boost::mutex::scoped_lock lock(mutex);
+    stopping = true;
+  }
+  jobAvailable.notify_all();
+  workers.join_all(); // workers return once the queue is empty
+}
+
+unsigned int WorkerPool::size() const
+{
+  return nbWorkers;
+}
+
+void WorkerPool::post(const Job &job)
+{
+  boost::mutex::scoped_lock lock(mutex);
+  queue.push_back(job);
+  jobAvailable.notify_one();
+}
+
+void WorkerPool::wait()
+{
+  boost::mutex::scoped_lock lock(mutex);
+  while (!queue.empty() || (busyWorkers > 0))
+    allDone.wait(lock);
+  if (error) {
+    boost::exception_ptr e = error;
+    error = boost::exception_ptr();
+    boost::rethrow_exception(e);
+  }
+}
+
+void WorkerPool::run(const vector<Job> &jobs)
+{
+  {
+    boost::mutex::scoped_lock lock(mutex);
+    queue.insert(queue.end(), jobs.begin(), jobs.end());
+    jobAvailable.notify_all();
+    while (execute(lock)) // help instead of idling
+      ;
+  }
+  wait();
+}
+
+void WorkerPool::work()
+{
+  boost::mutex::scoped_lock lock(mutex);
+  while (true) {
+    while (queue.empty() && !stopping)
+      jobAvailable.wait(lock);
+    if (queue.empty()) // stopping
+      return;
+    execute(lock);
+  }
+}
+
+bool WorkerPool::execute(boost::mutex::scoped_lock &lock)
+{
+  if (queue.empty())
+    return false;
+  Job job = queue.front();
+  queue.pop_front();
+  ++busyWorkers;
+  lock.unlock();
+  try {
+    job();
+  } catch (...) {
+    lock.lock();
+    if (!error)
+      error = boost::current_exception();
+    lock.unlock();
+  }
+  lock.lock();
+  --busyWorkers;
+  if (queue.empty() && (busyWorkers == 0))
+    allDone.notify_all();
+  return true;
+}
+
+} // namespace
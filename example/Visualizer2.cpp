@@ -1,6 +1,7 @@
 #include "Visualizer2.hpp"
 
 #include <Gui3DQt/graphics.hpp>
+#include <Gui3DQt/GLState.hpp>
 
 Visualizer2::Visualizer2(QWidget *parent)
   : Gui3DQt::Visualizer(parent)
@@ -19,6 +20,14 @@ Visualizer2::~Visualizer2()
 
 void Visualizer2::paintGLOpaque()
 {
+  // example on how to read background-color (from the state cache of the painting widget, no driver query):
+  GLfloat clr[4];
+  Gui3DQt::GLState::current().getClearColor(clr);
+  bool brightBackg = (clr[0]+clr[1]+clr[2])/3 > 0.5; // bright background -> 1, dark background -> 0
+  if (brightBackg) // choose point color dependent on background
+    glColor3f(0.5, 0.0, 0.0);
+  else
+    glColor3f(0.5, 1.0, 1.0);
   glCallList(glListIndex+0); // call list at index 0
 }
 
@@ -39,11 +48,6 @@ void Visualizer2::regenerate()
   double y = ui.dsbY->value();
   unsigned int nbp = ui.sbNbPts->value();
   
-  // example on how to read background-color:
-  GLdouble clr[4];
-  glGetDoublev(GL_COLOR_CLEAR_VALUE, &(clr[0]));
-  bool brightBackg = (clr[0]+clr[1]+clr[2])/3 > 0.5; // bright background -> 1, dark background -> 0
-  
   // re-create list containing drawing commands
   glDeleteLists(glListIndex, 1);
   glListIndex = glGenLists(1); // generate a display list
@@ -51,10 +55,6 @@ void Visualizer2::regenerate()
   
   glPushMatrix();
   glTranslatef(x, y, 5.0); // shift to center
-  if (brightBackg) // choose point color dependent on background
-    glColor3f(0.5, 0.0, 0.0);
-  else
-    glColor3f(0.5, 1.0, 1.0);
   glPointSize(2); // size of rendered points
   glBegin(GL_POINTS);
   for (unsigned int i=0; i<nbp; ++i) { // render random points
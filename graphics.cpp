@@ -20,6 +20,7 @@
  *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "Gui3DQt/graphics.hpp"
+#include "Gui3DQt/GLState.hpp"
 
 #define _USE_MATH_DEFINES
 
@@ -28,6 +29,10 @@
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <boost/thread/mutex.hpp>
 
 namespace Gui3DQt {
 namespace Graphics {
@@ -83,7 +88,7 @@ double normalize_theta(double theta)  //inline
 
 void set_display_mode_2D(int w, int h)
 {
-  glDisable(GL_DEPTH_TEST);
+  GLState::current().disable(GL_DEPTH_TEST);
   glMatrixMode(GL_PROJECTION);
   glLoadIdentity();
   gluOrtho2D(0.0, (GLfloat)w, 0.0, (GLfloat)h);
@@ -93,7 +98,7 @@ void set_display_mode_2D(int w, int h)
 
 void set_display_mode_3D(int w, int h, float fovy, float zNear, float zFar)
 {
-  glEnable(GL_DEPTH_TEST);
+  GLState::current().enable(GL_DEPTH_TEST);
   glMatrixMode(GL_PROJECTION);
   glLoadIdentity();
   gluPerspective(fovy, w / (float)h, zNear, zFar);
@@ -252,37 +257,41 @@ void draw_arrowhead(double x, double y, double angle)
 }
 
 
-void draw_circle(double x, double y, double r, int filled)
+const double* unit_circle(int segments)
 {
-  int i;
-  double angle;
-
-  if(filled)
-    glBegin(GL_TRIANGLE_FAN);
-  else
-    glBegin(GL_LINE_LOOP);
-
-  for(i = 0; i < 20; i++) {
-    angle = i / 20.0 * M_PI * 2;
-    glVertex2f(x + r * cos(angle), y + r * sin(angle));
+  // function-local statics are initialized thread-safe and before any use (e.g. by other static objects)
+  static boost::mutex mutex;
+  static std::map<int, std::vector<double> > tables; // never changed after insertion, pointers stay valid
+  segments = std::max(segments, 3);
+  boost::mutex::scoped_lock lock(mutex);
+  std::vector<double> &table = tables[segments];
+  if (table.empty()) {
+    table.resize(2*segments);
+    for (int i = 0; i < segments; i++) {
+      double angle = i / (double)segments * M_PI * 2;
+      table[2*i] = cos(angle);
+      table[2*i+1] = sin(angle);
+    }
   }
-  glEnd();
+  return &table[0];
+}
+
+void draw_circle(double x, double y, double r, int filled)
+{
+  draw_ellipse(x, y, r, r, filled);
 }
 
 void draw_ellipse(double x, double y, double rx, double ry, int filled)
 {
-  int i;
-  double angle;
+  static const double *c = unit_circle(20); // looked up once
 
   if(filled)
     glBegin(GL_TRIANGLE_FAN);
   else
     glBegin(GL_LINE_LOOP);
 
-  for(i = 0; i < 20; i++) {
-    angle = i / 20.0 * M_PI * 2;
-    glVertex2f(x + rx * cos(angle), y + ry * sin(angle));
-  }
+  for(int i = 0; i < 20; i++)
+    glVertex2f(x + rx * c[2*i], y + ry * c[2*i+1]);
   glEnd();
 }
 
@@ -317,6 +326,126 @@ void draw_dashed_line(double x1, double y1, double x2,
   glEnd();
 }
 
+// Geometry of one arrow of the coordinate frame, pointing along -z with length 1
+// Triangle vertices:
+static const int frame_nTriangles = 8;
+
+static const float frame_triangle_vertices[72] = {
+  0.000000f,0.040000f,-0.800000f,0.028284f,0.028284f,-0.800000f,
+  0.000000f,0.000000f,-1.000000f,0.028284f,0.028284f,-0.800000f,
+  0.040000f,0.000000f,-0.800000f,0.000000f,0.000000f,-1.000000f,
+  0.040000f,0.000000f,-0.800000f,0.028284f,-0.028284f,-0.800000f,
+  0.000000f,0.000000f,-1.000000f,0.028284f,-0.028284f,-0.800000f,
+  0.000000f,-0.040000f,-0.800000f,0.000000f,0.000000f,-1.000000f,
+  0.000000f,-0.040000f,-0.800000f,-0.028284f,-0.028284f,-0.800000f,
+  0.000000f,0.000000f,-1.000000f,-0.028284f,-0.028284f,-0.800000f,
+  -0.040000f,0.000000f,-0.800000f,0.000000f,0.000000f,-1.000000f,
+  -0.040000f,0.000000f,-0.800000f,-0.028284f,0.028284f,-0.800000f,
+  0.000000f,0.000000f,-1.000000f,-0.028284f,0.028284f,-0.800000f,
+  0.000000f,0.040000f,-0.800000f,0.000000f,0.000000f,-1.000000f
+};
+
+// Triangle normals:
+static const float frame_triangle_normals[72] = {
+  0.000000f,0.980581f,-0.196116f,0.693375f,0.693375f,-0.196116f,
+  0.357407f,0.862856f,-0.357407f,0.693375f,0.693375f,-0.196116f,
+  0.980581f,0.000000f,-0.196116f,0.862856f,0.357407f,-0.357407f,
+  0.980581f,0.000000f,-0.196116f,0.693375f,-0.693375f,-0.196116f,
+  0.862856f,-0.357407f,-0.357407f,0.693375f,-0.693375f,-0.196116f,
+  0.000000f,-0.980581f,-0.196116f,0.357407f,-0.862856f,-0.357407f,
+  0.000000f,-0.980581f,-0.196116f,-0.693375f,-0.693375f,-0.196116f,
+  -0.357407f,-0.862856f,-0.357407f,-0.693375f,-0.693375f,-0.196116f,
+  -0.980581f,0.000000f,-0.196116f,-0.862856f,-0.357407f,-0.357407f,
+  -0.980581f,0.000000f,-0.196116f,-0.693375f,0.693375f,-0.196116f,
+  -0.862856f,0.357407f,-0.357407f,-0.693375f,0.693375f,-0.196116f,
+  0.000000f,0.980581f,-0.196116f,-0.357407f,0.862856f,-0.357407f
+};
+
+// Quad vertices:
+static const int frame_nQuads = 16;
+
+static const float frame_quad_vertices[192] = {
+  0.000000f,0.010000f,0.000000f,0.007000f,0.007000f,0.000000f,
+  0.007000f,0.007000f,-0.800000f,0.000000f,0.010000f,-0.800000f,
+  0.000000f,-0.010000f,0.000000f,-0.007000f,-0.007000f,0.000000f,
+  -0.007000f,-0.007000f,-0.800000f,0.000000f,-0.010000f,-0.800000f,
+  -0.007000f,-0.007000f,0.000000f,-0.010000f,0.000000f,0.000000f,
+  -0.010000f,0.000000f,-0.800000f,-0.007000f,-0.007000f,-0.800000f,
+  -0.010000f,0.000000f,0.000000f,-0.007000f,0.007000f,0.000000f,
+  -0.007000f,0.007000f,-0.800000f,-0.010000f,0.000000f,-0.800000f,
+  -0.007000f,0.007000f,0.000000f,0.000000f,0.010000f,0.000000f,
+  0.000000f,0.010000f,-0.800000f,-0.007000f,0.007000f,-0.800000f,
+  0.007000f,0.007000f,0.000000f,0.010000f,0.000000f,0.000000f,
+  0.010000f,0.000000f,-0.800000f,0.007000f,0.007000f,-0.800000f,
+  0.010000f,0.000000f,0.000000f,0.007000f,-0.007000f,0.000000f,
+  0.007000f,-0.007000f,-0.800000f,0.010000f,0.000000f,-0.800000f,
+  0.007000f,-0.007000f,0.000000f,0.000000f,-0.010000f,0.000000f,
+  0.000000f,-0.010000f,-0.800000f,0.007000f,-0.007000f,-0.800000f,
+  -0.007000f,0.007000f,-0.800000f,-0.028284f,0.028284f,-0.800000f,
+  -0.040000f,0.000000f,-0.800000f,-0.010000f,0.000000f,-0.800000f,
+  -0.010000f,0.000000f,-0.800000f,-0.040000f,0.000000f,-0.800000f,
+  -0.028284f,-0.028284f,-0.800000f,-0.007000f,-0.007000f,-0.800000f,
+  -0.007000f,-0.007000f,-0.800000f,-0.028284f,-0.028284f,-0.800000f,
+  0.000000f,-0.040000f,-0.800000f,0.000000f,-0.010000f,-0.800000f,
+  0.000000f,-0.010000f,-0.800000f,0.000000f,-0.040000f,-0.800000f,
+  0.028284f,-0.028284f,-0.800000f,0.007000f,-0.007000f,-0.800000f,
+  0.028284f,-0.028284f,-0.800000f,0.040000f,0.000000f,-0.800000f,
+  0.010000f,0.000000f,-0.800000f,0.007000f,-0.007000f,-0.800000f,
+  0.040000f,0.000000f,-0.800000f,0.028284f,0.028284f,-0.800000f,
+  0.007000f,0.007000f,-0.800000f,0.010000f,0.000000f,-0.800000f,
+  0.007000f,0.007000f,-0.800000f,0.028284f,0.028284f,-0.800000f,
+  0.000000f,0.040000f,-0.800000f,0.000000f,0.010000f,-0.800000f,
+  0.000000f,0.010000f,-0.800000f,0.000000f,0.040000f,-0.800000f,
+  -0.028284f,0.028284f,-0.800000f,-0.007000f,0.007000f,-0.800000f
+};
+
+// Quad normals:
+static const float frame_quad_normals[192] = {
+  0.000000f,1.000000f,0.000000f,0.707107f,0.707107f,0.000000f,
+  0.707107f,0.707107f,0.000000f,0.000000f,1.000000f,0.000000f,
+  0.000000f,-1.000000f,0.000000f,-0.707107f,-0.707107f,0.000000f,
+  -0.707107f,-0.707107f,0.000000f,0.000000f,-1.000000f,0.000000f,
+  -0.707107f,-0.707107f,0.000000f,-1.000000f,0.000000f,0.000000f,
+  -1.000000f,0.000000f,0.000000f,-0.707107f,-0.707107f,0.000000f,
+  -1.000000f,0.000000f,0.000000f,-0.707107f,0.707107f,0.000000f,
+  -0.707107f,0.707107f,0.000000f,-1.000000f,0.000000f,0.000000f,
+  -0.707107f,0.707107f,0.000000f,0.000000f,1.000000f,0.000000f,
+  0.000000f,1.000000f,0.000000f,-0.707107f,0.707107f,0.000000f,
+  0.707107f,0.707107f,0.000000f,1.000000f,0.000000f,0.000000f,
+  1.000000f,0.000000f,0.000000f,0.707107f,0.707107f,0.000000f,
+  1.000000f,0.000000f,0.000000f,0.707107f,-0.707107f,0.000000f,
+  0.707107f,-0.707107f,0.000000f,1.000000f,0.000000f,0.000000f,
+  0.707107f,-0.707107f,0.000000f,0.000000f,-1.000000f,0.000000f,
+  0.000000f,-1.000000f,0.000000f,0.707107f,-0.707107f,0.000000f,
+  0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
+  0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
+  0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
+  0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
+  0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
+  0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
+  0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
+  0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
+  0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
+  0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
+  0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
+  0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
+  0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
+  0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
+  0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
+  0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f
+};
+
+void coordinate_frame_arrow(const float **triangle_vertices, const float **triangle_normals, int *nTriangles,
+                            const float **quad_vertices, const float **quad_normals, int *nQuads)
+{
+  *triangle_vertices = frame_triangle_vertices;
+  *triangle_normals = frame_triangle_normals;
+  *nTriangles = frame_nTriangles;
+  *quad_vertices = frame_quad_vertices;
+  *quad_normals = frame_quad_normals;
+  *nQuads = frame_nQuads;
+}
+
 // Draw an X-Y-Z Frame. The red arrow corresponds to the X-Axis,
 // green to the Y-Axis, and blue to the Z-Axis.
 void draw_coordinate_frame(double scale)
@@ -325,115 +454,7 @@ void draw_coordinate_frame(double scale)
   const int a_modifyMaterialState = 0;
 
   //glDisable(GL_LIGHTING);
-  glDisable(GL_TEXTURE_2D);
-  // Triangle vertices:
-  static int nTriangles = 8;
-
-  static float triangle_vertices[72] = {
-    0.000000f,0.040000f,-0.800000f,0.028284f,0.028284f,-0.800000f,
-    0.000000f,0.000000f,-1.000000f,0.028284f,0.028284f,-0.800000f,
-    0.040000f,0.000000f,-0.800000f,0.000000f,0.000000f,-1.000000f,
-    0.040000f,0.000000f,-0.800000f,0.028284f,-0.028284f,-0.800000f,
-    0.000000f,0.000000f,-1.000000f,0.028284f,-0.028284f,-0.800000f,
-    0.000000f,-0.040000f,-0.800000f,0.000000f,0.000000f,-1.000000f,
-    0.000000f,-0.040000f,-0.800000f,-0.028284f,-0.028284f,-0.800000f,
-    0.000000f,0.000000f,-1.000000f,-0.028284f,-0.028284f,-0.800000f,
-    -0.040000f,0.000000f,-0.800000f,0.000000f,0.000000f,-1.000000f,
-    -0.040000f,0.000000f,-0.800000f,-0.028284f,0.028284f,-0.800000f,
-    0.000000f,0.000000f,-1.000000f,-0.028284f,0.028284f,-0.800000f,
-    0.000000f,0.040000f,-0.800000f,0.000000f,0.000000f,-1.000000f
-  };
-
-  // Triangle normals:
-  static float triangle_normals[72] = {
-    0.000000f,0.980581f,-0.196116f,0.693375f,0.693375f,-0.196116f,
-    0.357407f,0.862856f,-0.357407f,0.693375f,0.693375f,-0.196116f,
-    0.980581f,0.000000f,-0.196116f,0.862856f,0.357407f,-0.357407f,
-    0.980581f,0.000000f,-0.196116f,0.693375f,-0.693375f,-0.196116f,
-    0.862856f,-0.357407f,-0.357407f,0.693375f,-0.693375f,-0.196116f,
-    0.000000f,-0.980581f,-0.196116f,0.357407f,-0.862856f,-0.357407f,
-    0.000000f,-0.980581f,-0.196116f,-0.693375f,-0.693375f,-0.196116f,
-    -0.357407f,-0.862856f,-0.357407f,-0.693375f,-0.693375f,-0.196116f,
-    -0.980581f,0.000000f,-0.196116f,-0.862856f,-0.357407f,-0.357407f,
-    -0.980581f,0.000000f,-0.196116f,-0.693375f,0.693375f,-0.196116f,
-    -0.862856f,0.357407f,-0.357407f,-0.693375f,0.693375f,-0.196116f,
-    0.000000f,0.980581f,-0.196116f,-0.357407f,0.862856f,-0.357407f
-  };
-
-  // Quad vertices:
-  static int nQuads = 16;
-
-  static float quad_vertices[192] = {
-    0.000000f,0.010000f,0.000000f,0.007000f,0.007000f,0.000000f,
-    0.007000f,0.007000f,-0.800000f,0.000000f,0.010000f,-0.800000f,
-    0.000000f,-0.010000f,0.000000f,-0.007000f,-0.007000f,0.000000f,
-    -0.007000f,-0.007000f,-0.800000f,0.000000f,-0.010000f,-0.800000f,
-    -0.007000f,-0.007000f,0.000000f,-0.010000f,0.000000f,0.000000f,
-    -0.010000f,0.000000f,-0.800000f,-0.007000f,-0.007000f,-0.800000f,
-    -0.010000f,0.000000f,0.000000f,-0.007000f,0.007000f,0.000000f,
-    -0.007000f,0.007000f,-0.800000f,-0.010000f,0.000000f,-0.800000f,
-    -0.007000f,0.007000f,0.000000f,0.000000f,0.010000f,0.000000f,
-    0.000000f,0.010000f,-0.800000f,-0.007000f,0.007000f,-0.800000f,
-    0.007000f,0.007000f,0.000000f,0.010000f,0.000000f,0.000000f,
-    0.010000f,0.000000f,-0.800000f,0.007000f,0.007000f,-0.800000f,
-    0.010000f,0.000000f,0.000000f,0.007000f,-0.007000f,0.000000f,
-    0.007000f,-0.007000f,-0.800000f,0.010000f,0.000000f,-0.800000f,
-    0.007000f,-0.007000f,0.000000f,0.000000f,-0.010000f,0.000000f,
-    0.000000f,-0.010000f,-0.800000f,0.007000f,-0.007000f,-0.800000f,
-    -0.007000f,0.007000f,-0.800000f,-0.028284f,0.028284f,-0.800000f,
-    -0.040000f,0.000000f,-0.800000f,-0.010000f,0.000000f,-0.800000f,
-    -0.010000f,0.000000f,-0.800000f,-0.040000f,0.000000f,-0.800000f,
-    -0.028284f,-0.028284f,-0.800000f,-0.007000f,-0.007000f,-0.800000f,
-    -0.007000f,-0.007000f,-0.800000f,-0.028284f,-0.028284f,-0.800000f,
-    0.000000f,-0.040000f,-0.800000f,0.000000f,-0.010000f,-0.800000f,
-    0.000000f,-0.010000f,-0.800000f,0.000000f,-0.040000f,-0.800000f,
-    0.028284f,-0.028284f,-0.800000f,0.007000f,-0.007000f,-0.800000f,
-    0.028284f,-0.028284f,-0.800000f,0.040000f,0.000000f,-0.800000f,
-    0.010000f,0.000000f,-0.800000f,0.007000f,-0.007000f,-0.800000f,
-    0.040000f,0.000000f,-0.800000f,0.028284f,0.028284f,-0.800000f,
-    0.007000f,0.007000f,-0.800000f,0.010000f,0.000000f,-0.800000f,
-    0.007000f,0.007000f,-0.800000f,0.028284f,0.028284f,-0.800000f,
-    0.000000f,0.040000f,-0.800000f,0.000000f,0.010000f,-0.800000f,
-    0.000000f,0.010000f,-0.800000f,0.000000f,0.040000f,-0.800000f,
-    -0.028284f,0.028284f,-0.800000f,-0.007000f,0.007000f,-0.800000f
-  };
-
-  // Quad normals:
-  static float quad_normals[192] = {
-    0.000000f,1.000000f,0.000000f,0.707107f,0.707107f,0.000000f,
-    0.707107f,0.707107f,0.000000f,0.000000f,1.000000f,0.000000f,
-    0.000000f,-1.000000f,0.000000f,-0.707107f,-0.707107f,0.000000f,
-    -0.707107f,-0.707107f,0.000000f,0.000000f,-1.000000f,0.000000f,
-    -0.707107f,-0.707107f,0.000000f,-1.000000f,0.000000f,0.000000f,
-    -1.000000f,0.000000f,0.000000f,-0.707107f,-0.707107f,0.000000f,
-    -1.000000f,0.000000f,0.000000f,-0.707107f,0.707107f,0.000000f,
-    -0.707107f,0.707107f,0.000000f,-1.000000f,0.000000f,0.000000f,
-    -0.707107f,0.707107f,0.000000f,0.000000f,1.000000f,0.000000f,
-    0.000000f,1.000000f,0.000000f,-0.707107f,0.707107f,0.000000f,
-    0.707107f,0.707107f,0.000000f,1.000000f,0.000000f,0.000000f,
-    1.000000f,0.000000f,0.000000f,0.707107f,0.707107f,0.000000f,
-    1.000000f,0.000000f,0.000000f,0.707107f,-0.707107f,0.000000f,
-    0.707107f,-0.707107f,0.000000f,1.000000f,0.000000f,0.000000f,
-    0.707107f,-0.707107f,0.000000f,0.000000f,-1.000000f,0.000000f,
-    0.000000f,-1.000000f,0.000000f,0.707107f,-0.707107f,0.000000f,
-    0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
-    0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
-    0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
-    0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
-    0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
-    0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
-    0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
-    0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
-    0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
-    0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
-    0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
-    0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
-    0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
-    0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
-    0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f,
-    0.000000f,0.000000f,1.000000f,0.000000f,0.000000f,1.000000f
-  };
-
+  GLState::current().disable(GL_TEXTURE_2D);
   glEnableClientState(GL_NORMAL_ARRAY);
   glEnableClientState(GL_VERTEX_ARRAY);
 
@@ -466,13 +487,13 @@ void draw_coordinate_frame(double scale)
 
     glScaled(a_axisThicknessScale,a_axisThicknessScale,scale);
 
-    glVertexPointer(3, GL_FLOAT, 0, triangle_vertices);
-    glNormalPointer(GL_FLOAT, 0, triangle_normals);
-    glDrawArrays(GL_TRIANGLES, 0, nTriangles*3);
+    glVertexPointer(3, GL_FLOAT, 0, frame_triangle_vertices);
+    glNormalPointer(GL_FLOAT, 0, frame_triangle_normals);
+    glDrawArrays(GL_TRIANGLES, 0, frame_nTriangles*3);
 
-    glVertexPointer(3, GL_FLOAT, 0, quad_vertices);
-    glNormalPointer(GL_FLOAT, 0, quad_normals);
-    glDrawArrays(GL_QUADS, 0, nQuads*4);
+    glVertexPointer(3, GL_FLOAT, 0, frame_quad_vertices);
+    glNormalPointer(GL_FLOAT, 0, frame_quad_normals);
+    glDrawArrays(GL_QUADS, 0, frame_nQuads*4);
 
     glPopMatrix();
   }
@@ -483,9 +504,9 @@ void draw_coordinate_frame(double scale)
 
 void draw_bounding_box(double x, double y, double theta, double w, double l)
 {
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-  glEnable(GL_LINE_SMOOTH);
+  GLState::current().enable(GL_BLEND);
+  GLState::current().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  GLState::current().enable(GL_LINE_SMOOTH);
 
   glLineWidth(2);
 
@@ -514,8 +535,8 @@ void draw_bounding_box(double x, double y, double theta, double w, double l)
   glPopMatrix();
   glLineWidth(1);
 
-  glDisable(GL_LINE_SMOOTH);
-  glDisable(GL_BLEND);
+  GLState::current().disable(GL_LINE_SMOOTH);
+  GLState::current().disable(GL_BLEND);
 }
 
 void draw_nline_flag(double x, double y, double w, double h, int num_lines, char **line, int color, double camera_pan)
@@ -577,9 +598,9 @@ void draw_observed_car(double x, double y, double theta,
   char *text[7];
 //  int color = abs(id) % 13;
 
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-  glEnable(GL_LINE_SMOOTH);
+  GLState::current().enable(GL_BLEND);
+  GLState::current().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  GLState::current().enable(GL_LINE_SMOOTH);
 
   glLineWidth(2);
 
@@ -661,8 +682,8 @@ void draw_observed_car(double x, double y, double theta,
 
   glLineWidth(1);
 
-  glDisable(GL_LINE_SMOOTH);
-  glDisable(GL_BLEND);
+  GLState::current().disable(GL_LINE_SMOOTH);
+  GLState::current().disable(GL_BLEND);
 }
 
 void draw_observed_car_old(double x, double y, double theta,
@@ -675,9 +696,9 @@ void draw_observed_car_old(double x, double y, double theta,
   char *text[7];
   int color = abs(id) % 13;
 
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-  glEnable(GL_LINE_SMOOTH);
+  GLState::current().enable(GL_BLEND);
+  GLState::current().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  GLState::current().enable(GL_LINE_SMOOTH);
 
   glLineWidth(2);
 
@@ -732,8 +753,8 @@ void draw_observed_car_old(double x, double y, double theta,
   }
   glLineWidth(1);
 
-  glDisable(GL_LINE_SMOOTH);
-  glDisable(GL_BLEND);
+  GLState::current().disable(GL_LINE_SMOOTH);
+  GLState::current().disable(GL_BLEND);
 }
 
 
@@ -788,11 +809,11 @@ void draw_distance_rings(double x, double y, double theta,
 {
   int i,j;
   char buf[255];
-  float angle;
+  static const double *c = unit_circle(100); // looked up once
   glLineWidth(0.5);
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-  glEnable(GL_LINE_SMOOTH);
+  GLState::current().enable(GL_BLEND);
+  GLState::current().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  GLState::current().enable(GL_LINE_SMOOTH);
 
   // draw radius
   glPushMatrix();
@@ -804,15 +825,13 @@ void draw_distance_rings(double x, double y, double theta,
     sprintf(buf,"%d",i);
     draw_stroke_text_2D(i, 0, GLUT_STROKE_ROMAN, 3.0, buf);
     glBegin(GL_LINE_LOOP);
-    for(j = 0; j < 100; j++) {
-      angle = j / 100.0 * M_PI * 2;
-      glVertex3f(i * cos(angle), i * sin(angle), 0);
-    }
+    for(j = 0; j < 100; j++)
+      glVertex3f(i * c[2*j], i * c[2*j+1], 0);
     glEnd();
   }
   glPopMatrix();
-  glDisable(GL_LINE_SMOOTH);
-  glDisable(GL_BLEND);
+  GLState::current().disable(GL_LINE_SMOOTH);
+  GLState::current().disable(GL_BLEND);
 }
 
 void draw_grid(double center_x, double center_y)
@@ -854,7 +873,7 @@ void draw_grid(double center_x, double center_y)
 // it is required that x1<x2, y1<y2, z1<z2!
 void draw_cube_solid(float x1,float x2,float y1,float y2,float z1,float z2)
 {
-  glEnable(GL_CULL_FACE);
+  GLState::current().enable(GL_CULL_FACE);
   glCullFace(GL_FRONT);
   glBegin(GL_QUADS);  //front side is defined as side where points are in counter-clock-wise direction - only with GL_QUADS, here it's 1,2,4,3 - 3,4,6,5
     glVertex3f(x1, y1, z1); //x,y,z
@@ -887,7 +906,7 @@ void draw_cube_solid(float x1,float x2,float y1,float y2,float z1,float z2)
     glVertex3f(x2, y1, z2); //x,y,z
     glVertex3f(x2, y2, z2); //x,y,z
   glEnd();
-  glDisable(GL_CULL_FACE);
+  GLState::current().disable(GL_CULL_FACE);
 }
 
 void draw_cube_cage(float x1,float x2,float y1,float y2,float z1,float z2)
@@ -0,0 +1,92 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   CoordinateFrameInstances.hpp
+ *  \brief  Draws many coordinate frames from one cached mesh
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_COORDINATEFRAMEINSTANCES_HPP_
+#define GUI3DQT_COORDINATEFRAMEINSTANCES_HPP_
+
+#include <vector>
+#include <GL/gl.h>
+#include <QtOpenGL/QGLBuffer>
+
+class QGLShaderProgram;
+
+namespace Gui3DQt {
+
+namespace Instancing { struct Functions; }
+
+/*!
+  \class CoordinateFrameInstances
+  \brief Instanced drawing of coordinate frames (red x-, green y-, blue z-axis)
+
+  The arrows of Graphics::draw_coordinate_frame() are combined into one mesh
+  which is uploaded once into a vertex buffer. Each added frame only stores
+  its pose and scale, and render() draws all of them with one instanced
+  draw call (shaded by the angle to the viewing direction). If instancing is
+  not supported, the mesh is drawn once per frame with the matrix stack and
+  the fixed-function lighting instead.
+*/
+class CoordinateFrameInstances
+{
+public:
+  CoordinateFrameInstances();
+  virtual ~CoordinateFrameInstances(); //!< the GL context must be current if render() was called
+
+  void    clear(); //!< removes all frames, keeps the allocated memory
+  size_t  size() const;
+  void    reserve(size_t nbFrames);
+  void    add(double x, double y, double z, double roll, double pitch, double yaw, double scale = 1); //!< rotation is Rz(yaw)*Ry(pitch)*Rx(roll)
+  void    add(const double *transform, double scale = 1); //!< 4x4 homogeneous transform, column-major as in OpenGL
+
+  void    render(); //!< uploads changes and draws all frames, call from within a paint function
+
+private:
+  struct Vertex {
+    GLfloat x, y, z;
+    GLfloat nx, ny, nz;
+    GLubyte r, g, b, a;
+  };
+  struct Instance {
+    GLfloat m[12]; // columns of the scaled 3x4 transform
+  };
+
+  std::vector<Instance> instances;
+  bool          dirty; // instances differ from the buffer content
+  bool          initialized; // mesh uploaded, instancing support determined
+  GLsizei       nbMeshVertices;
+  QGLBuffer     mesh; // triangles of all three arrows
+  QGLBuffer     instanceBuffer;
+  GLsizei       instanceCapacity;
+  GLsizei       nbInstances; // uploaded count
+  QGLShaderProgram *program; // NULL if instancing is not available
+  Instancing::Functions *instancing; // entry points for instanced drawing
+
+  void          initialize();
+  void          upload();
+  void          renderInstanced();
+  void          renderLoop();
+};
+
+} // namespace
+
+#endif // GUI3DQT_COORDINATEFRAMEINSTANCES_HPP_
@@ -0,0 +1,60 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   EllipseInstances.hpp
+ *  \brief  Draws many circles and ellipses from one precomputed unit mesh
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_ELLIPSEINSTANCES_HPP_
+#define GUI3DQT_ELLIPSEINSTANCES_HPP_
+
+#include "ShapeInstances.hpp"
+
+namespace Gui3DQt {
+
+/*!
+  \class EllipseInstances
+  \brief Instanced drawing of circles, ellipses and rings
+
+  A unit circle is tesselated once (filled as triangle fan and as outline)
+  and each added shape only stores its center, radii, orientation, color
+  and fill mode. render() draws all filled shapes and all outlines with one
+  instanced draw call each, no trigonometric functions are evaluated on the CPU.
+  This is intended for e.g. thousands of uncertainty ellipses or range rings.
+*/
+class EllipseInstances : public ShapeInstances
+{
+public:
+  EllipseInstances(int segments = 20); //!< segments of the unit circle, 20 as draw_circle(), rings look better with more
+  virtual ~EllipseInstances();
+
+  void    addCircle(double x, double y, double r, bool filled, double z = 0);
+  void    addEllipse(double x, double y, double rx, double ry, double theta, bool filled, double z = 0); //!< theta rotates the rx axis counter-clockwise
+  void    addRings(double x, double y, double max_distance, double distance_increment, double z = 0); //!< concentric outlines as in draw_distance_rings(), without labels
+
+  static std::vector<GLfloat> unitCircle(int segments, bool filled); //!< vertices for addShape(), as GL_TRIANGLE_FAN or GL_LINE_LOOP
+
+private:
+  int     fillShape, outlineShape;
+};
+
+} // namespace
+
+#endif // GUI3DQT_ELLIPSEINSTANCES_HPP_
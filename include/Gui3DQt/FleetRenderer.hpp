@@ -0,0 +1,110 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   FleetRenderer.hpp
+ *  \brief  Draws large numbers of vehicle models with instancing
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_FLEETRENDERER_HPP_
+#define GUI3DQT_FLEETRENDERER_HPP_
+
+#include <vector>
+#include <GL/gl.h>
+#include <QtOpenGL/QGLBuffer>
+#include <boost/shared_ptr.hpp>
+#include "ModelAssets.hpp"
+
+class QGLShaderProgram;
+
+namespace Gui3DQt {
+
+namespace Instancing { struct Functions; }
+
+class IndexedModel;
+
+/*!
+  \class FleetRenderer
+  \brief Draws many vehicles (the model of PassatModel::draw) with arbitrary colors
+
+  Each vehicle is given by its pose, body color, wheel and velodyne angle. Their
+  transforms are computed once per change and uploaded into instance buffers, then
+  body, tires and velodyne of all vehicles are drawn with one instanced draw call per
+  material and level of detail. Distant vehicles are drawn with the simplified models
+  of ModelAssets, chosen per vehicle by its projected length as in PassatModel::draw;
+  the instance buffers are only rewritten when a vehicle changes its level.
+  There is no limit on the number of vehicles or colors.
+  If instancing is not supported, the vehicles are drawn one by one.
+*/
+class FleetRenderer
+{
+public:
+  struct Vehicle {
+    double x, y, z; //!< geometrical center, as in PassatModel::draw
+    double roll, pitch, yaw; //!< rotation is Rz(yaw)*Ry(pitch)*Rx(roll)
+    float  r, g, b; //!< body color, 0..1
+    double wheelAngle; //!< rad
+    double velodyneAngle; //!< rad
+  };
+
+  FleetRenderer();
+  virtual ~FleetRenderer(); //!< the GL context must be current if render() was called
+
+  void    clear(); //!< removes all vehicles, keeps the allocated memory
+  size_t  size() const;
+  void    reserve(size_t nbVehicles);
+  void    add(const Vehicle &vehicle);
+  void    setVehicles(const std::vector<Vehicle> &vehicles); //!< replaces all vehicles
+
+  void    render(); //!< uploads changes and draws all vehicles, opaque parts first
+  void    renderOpaque(); //!< same for the opaque parts only, call from paintGLOpaque()
+  void    renderTranslucent(); //!< same for the translucent parts only (e.g. head lights), call from paintGLTranslucent()
+
+private:
+  struct Instance {
+    GLfloat m[12]; // columns of the 3x4 transform
+    GLubyte rgba[4];
+  };
+  enum Part {BODY = 0, TIRES, VELODYNE, NB_PARTS};
+
+  std::vector<Vehicle> vehicles;
+  std::vector<Instance> instances[NB_PARTS]; // 1 body, 4 tires and 1 velodyne per vehicle, in the order of the vehicles
+  std::vector<int> lods; // level of detail of each vehicle
+  GLsizei       lodFirst[ModelAssets::NB_LODS+1]; // vehicles of level l are [lodFirst[l], lodFirst[l+1]) in the instance buffers
+  std::vector<Instance> staging; // instances ordered by level of detail for the upload
+  bool          dirty; // vehicles differ from the instance buffers
+  bool          initialized; // models obtained, instancing support determined
+  boost::shared_ptr<IndexedModel> models[NB_PARTS][ModelAssets::NB_LODS]; // shared with PassatModel through ModelAssets
+  QGLBuffer     instanceBuffers[NB_PARTS];
+  GLsizei       instanceCapacity[NB_PARTS];
+  QGLShaderProgram *program; // NULL if instancing is not available
+  Instancing::Functions *instancing; // entry points for instanced drawing
+
+  void          initialize();
+  void          computeInstances();
+  bool          selectLods(); // returns true if a vehicle changed its level
+  void          upload();
+  void          render(int selection);
+  void          renderInstanced(int selection);
+  void          renderLoop(int selection);
+};
+
+} // namespace
+
+#endif // GUI3DQT_FLEETRENDERER_HPP_
@@ -0,0 +1,150 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   FrameWriter.hpp
+ *  \brief  Stores grabbed frames as numbered image files or a video stream in background threads
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_FRAMEWRITER_HPP_
+#define GUI3DQT_FRAMEWRITER_HPP_
+
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
+
+#include <QImage>
+
+namespace Gui3DQt {
+
+/*!
+  \class FrameWriter
+  \brief Encodes and saves frames in a pool of background threads
+
+  Frames passed to push() are put into a bounded queue and encoded/saved by
+  the worker threads, so the caller (usually the GUI thread) does not wait for
+  the encoder. Filenames are built from a pattern where "*" is replaced by a
+  5-digit frame number. The first number is determined by a single scan of the
+  output directory, existing files are never overwritten.
+  If the queue is full, the QueuePolicy decides whether the caller waits
+  (backpressure) or a frame is dropped.
+
+  Instead of single image files, frames can be appended to a YUV4MPEG2 stream
+  (see Sink). The RGB to YUV 4:2:0 conversion runs in parallel on the workers,
+  the frames are written in push order. The stream is opened with the size of
+  the first frame (cropped to even dimensions) and stays open until
+  closeStream() is called, frames of different size are scaled.
+*/
+class FrameWriter
+{
+public:
+  enum Format {
+    FF_Auto,    //!< format is deduced from the file pattern's extension
+    FF_PNG,     //!< PNG with default compression
+    FF_PNGFast, //!< PNG with fastest compression, still lossless
+    FF_BMP,     //!< uncompressed
+    FF_PPM      //!< uncompressed
+  };
+  enum QueuePolicy {
+    QP_Block,      //!< wait until the encoders have room for the frame, no frame gets lost
+    QP_DropNewest, //!< discard the frame that is pushed
+    QP_DropOldest  //!< discard the oldest frame in the queue
+  };
+  enum Sink {
+    OS_Images,      //!< each frame is stored as a numbered image file
+    OS_Y4MFile,     //!< frames are appended to a numbered .y4m file
+    OS_EncoderPipe  //!< frames are piped as YUV4MPEG2 into the stdin of the encoder command
+  };
+
+  FrameWriter(unsigned int nbThreads = 2, unsigned int queueSize = 8);
+  virtual ~FrameWriter(); //!< waits until all queued frames are written
+
+  void         setOutput(const boost::filesystem::path &dir, const std::string &pattern); //!< "*" in pattern will be replaced by the frame number
+  void         setFormat(Format format);
+  Format       getFormat() const;
+  void         setQueuePolicy(QueuePolicy policy);
+  QueuePolicy  getQueuePolicy() const;
+  void         setSink(Sink sink); //!< closes an open stream
+  Sink         getSink() const;
+  void         setEncoderCommand(const std::string &cmd); //!< "%1" in cmd will be replaced by the numbered file pattern without extension, escaped to be placed within single quotes (e.g. '%1.mp4')
+  std::string  getEncoderCommand() const;
+  void         setStreamFrameRate(unsigned int fps); //!< frame rate written into the stream header, effective for the next stream
+
+  bool         push(const QImage &frame); //!< queues the frame according to the current policy, returns false if the frame was dropped
+  bool         push(const QImage &frame, QueuePolicy policy);
+  bool         pushStill(const QImage &frame); //!< always stores the frame as image file, regardless of the sink
+  void         flush(); //!< waits until all queued frames are written
+  void         closeStream(); //!< flushes and closes the stream, the next frame starts a new one
+  unsigned int droppedFrames() const; //!< number of frames dropped since the last call to setOutput
+
+private:
+  struct Job {
+    QImage      image;
+    Format      format;
+    Sink        sink;
+    unsigned int sequence; // position in the stream
+  };
+
+  const unsigned int      capacity;
+  mutable boost::mutex    mutex; // protects all members below
+  boost::condition_variable queueNotEmpty;
+  boost::condition_variable queueNotFull;
+  boost::condition_variable allDone;
+  std::deque<Job>         queue;
+  unsigned int            busyWorkers;
+  bool                    stopping;
+  boost::filesystem::path outputDirectory;
+  std::string             filePattern;
+  Format                  format;
+  QueuePolicy             policy;
+  bool                    counterValid; // false until the output directory was scanned
+  unsigned int            frameCounter;
+  unsigned int            dropped;
+  Sink                    sink;
+  std::string             encoderCommand;
+  unsigned int            streamFps;
+  int                     streamWidth;  // 0 until the first frame of a stream was taken from the queue
+  int                     streamHeight;
+  unsigned int            streamSequence; // next position assigned to a stream frame
+  unsigned int            streamNextWrite; // position of the frame to be written next
+  std::string             streamTarget; // filename or command line of the current stream
+  boost::condition_variable streamTurn;
+  FILE                    *stream; // stream and flags are only accessed by the worker whose frame is at streamNextWrite
+  bool                    streamIsPipe;
+  bool                    streamFailed;
+  boost::thread_group     workers;
+
+  void                    work(); // thread function of the workers
+  void                    writeStill(const Job &job, const std::string &filename);
+  void                    writeStream(const Job &job, int width, int height);
+  bool                    openStream(Sink sink, const std::string &target, int width, int height, unsigned int fps);
+  void                    closeStreamFile();
+  std::string             filenamePattern(Format fmt) const; // pattern with extension matching fmt
+  std::string             streamFilenamePattern(Sink sink) const; // pattern with .y4m extension or without extension for the encoder
+  std::string             nextFilename(const std::string &pattern); // must be called with locked mutex
+  void                    scanOutputDirectory(const std::string &pattern); // must be called with locked mutex
+};
+
+} // namespace
+
+#endif // GUI3DQT_FRAMEWRITER_HPP_
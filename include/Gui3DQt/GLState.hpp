@@ -0,0 +1,91 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   GLState.hpp
+ *  \brief  Shadow copy of OpenGL state avoiding redundant changes and queries
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_GLSTATE_HPP_
+#define GUI3DQT_GLSTATE_HPP_
+
+#include <map>
+#include <GL/gl.h>
+
+namespace Gui3DQt {
+
+/*!
+  \class GLState
+  \brief Keeps a copy of frequently used OpenGL state of one context
+
+  Setting state through this class skips calls that would not change anything,
+  and querying it returns the cached value instead of stalling on the driver.
+  MNavWidget owns one instance, sets the state of its context only through it and
+  makes it current() while initializing and painting. At the beginning of each
+  paint it sets its default state unconditionally, so the cache is in sync again
+  even if some code changed the state directly in the last frame.
+
+  Changes made directly with glEnable() etc. within a glPushAttrib()/glPopAttrib()
+  pair are fine. Code that changes state directly and leaves it changed has to call
+  invalidate() afterwards, the next query then reads the value from the driver once.
+
+  MNavWidget also publishes the camera (view and projection matrix) it sets up, so
+  paint functions can project without reading the matrices back from the driver.
+*/
+class GLState
+{
+public:
+  explicit GLState(bool tracking = true); //!< if tracking is false, all calls are forwarded and all queries go to the driver
+
+  static GLState& current(); //!< the state of the MNavWidget initializing or painting, otherwise a non-tracking instance
+  static void setCurrent(GLState *state); //!< NULL selects the non-tracking instance
+
+  void    invalidate(); //!< forgets all cached values
+
+  bool    isEnabled(GLenum cap);
+  void    enable(GLenum cap);
+  void    disable(GLenum cap);
+  void    set(GLenum cap, bool enabled);
+  void    depthMask(bool enabled);
+  void    blendFunc(GLenum sfactor, GLenum dfactor);
+  void    clearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+  void    getClearColor(GLfloat *rgba);
+  void    viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+  void    getViewport(GLint *xywh);
+  void    setCamera(const GLdouble *view, const GLdouble *projection); //!< column-major 4x4 matrices as set up before painting
+  void    getViewMatrix(GLdouble *m); //!< modelview matrix of the camera, read from the driver if no camera was set
+  void    getProjectionMatrix(GLdouble *m); //!< read from the driver if no camera was set
+
+private:
+  bool    tracking;
+  std::map<GLenum, bool> caps; // known capabilities
+  bool    depthMaskKnown, depthMaskValue;
+  bool    blendFuncKnown;
+  GLenum  blendSrc, blendDst;
+  bool    clearColorKnown;
+  GLfloat clearColorValue[4];
+  bool    viewportKnown;
+  GLint   viewportValue[4];
+  bool    cameraKnown;
+  GLdouble viewMatrix[16], projectionMatrix[16];
+};
+
+} // namespace
+
+#endif // GUI3DQT_GLSTATE_HPP_
@@ -0,0 +1,77 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   ImageStream.hpp
+ *  \brief  Passes video-rate images from a producer thread to the GUI, dropping stale frames
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_IMAGESTREAM_HPP_
+#define GUI3DQT_IMAGESTREAM_HPP_
+
+#include <QObject>
+#include <QImage>
+#include <boost/atomic.hpp>
+
+#include "TripleBuffer.hpp"
+
+namespace Gui3DQt {
+
+/*!
+  \class ImageStream
+  \brief Hands images from one producer thread to the GUI thread with bounded memory and latency
+
+  The producer fills the buffer returned by frameBuffer() and calls publish().
+  Three image buffers are recycled (see TripleBuffer), they are only
+  reallocated if size or format change. At most one notification is queued
+  to the GUI thread at a time, when it is processed, frameReady() is emitted
+  with the newest frame. Frames published in the meantime are dropped.
+
+  The receiver should not keep references to older frames, otherwise the
+  producer's next buffer is detached (i.e. reallocated) when written.
+*/
+class ImageStream : public QObject
+{
+  Q_OBJECT
+
+public:
+  ImageStream(QObject *parent = 0);
+  virtual ~ImageStream();
+
+  QImage&       frameBuffer(int width, int height, QImage::Format format); //!< producer only: buffer for the next frame, content is an older frame
+  void          publish(); //!< producer only: passes the frame buffer to the GUI, never blocks
+  void          publish(const QImage &img); //!< producer only: copies img into the frame buffer and publishes it
+  unsigned int  droppedFrames() const; //!< number of published frames that were never displayed
+
+signals:
+  void          frameReady(QImage&); //!< emitted in the GUI thread with the newest frame
+
+private slots:
+  void          deliver();
+
+private:
+  TripleBuffer<QImage>        frames;
+  boost::atomic<bool>         notificationPending;
+  boost::atomic<unsigned int> published;
+  boost::atomic<unsigned int> delivered;
+};
+
+} // namespace
+
+#endif // GUI3DQT_IMAGESTREAM_HPP_
@@ -0,0 +1,93 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   ImageView.hpp
+ *  \brief  Provides an OpenGL widget displaying a 2D image as texture
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_IMAGEVIEW_HPP_
+#define GUI3DQT_IMAGEVIEW_HPP_
+
+#include <QtOpenGL/QGLWidget>
+#include <QImage>
+#include <QPointF>
+#include <boost/shared_ptr.hpp>
+
+#include "RawImage.hpp"
+
+namespace Gui3DQt {
+
+class ImageTexture; // defined in ImageView.cpp
+
+/*!
+  \class ImageView
+  \brief Displays a QImage as OpenGL texture, zooming and panning is done by the GPU
+
+  setImage() only keeps a reference to the image, the upload happens on the
+  next paint of a visible view. If several images are set in between, only the
+  last one is uploaded. Textures of the same size and format are updated in
+  place (glTexSubImage2D).
+  RawImages (grayscale, Bayer, depth) are uploaded in their native format and
+  converted by a fragment shader.
+  Several views can display the same texture (see shareImage()), so an image
+  shown in two places is uploaded only once. This requires shared GL contexts,
+  i.e. all views should be created with the same shareWidget.
+
+  Navigation: drag with the left mouse button to pan, mouse wheel to zoom.
+*/
+class ImageView : public QGLWidget
+{
+  Q_OBJECT
+
+public:
+  ImageView(QWidget *parent = 0, const QGLWidget *shareWidget = 0);
+  virtual ~ImageView();
+
+  virtual QSize minimumSizeHint() const; // inherited from QWidget
+  virtual QSize sizeHint() const; // inherited from QWidget
+
+  void   setImage(const QImage &img); //!< displays img in this view and all views sharing its texture
+  void   setImage(const RawImage &img); //!< as above, img is debayered/normalized/colormapped on the GPU
+  bool   shareImage(ImageView &other); //!< displays the texture of other from now on, returns false if the GL contexts are not shared
+  QSize  imageSize() const;
+
+  void   setFitToWindow(bool fit); //!< if set, the image is scaled to the widget size (keeping its aspect ratio) and zoom/pan is disabled
+  void   zoom(double factor); //!< zooms around the center of the widget
+  void   resetView(); //!< zoom 1, top left corner of the image at the top left corner of the widget
+
+protected:
+  virtual void initializeGL(); // inherited from QGLWidget
+  virtual void paintGL(); // inherited from QGLWidget
+  virtual void resizeGL(int width, int height); // inherited from QGLWidget
+  virtual void mousePressEvent(QMouseEvent *event); // inherited from QWidget
+  virtual void mouseMoveEvent(QMouseEvent *event); // inherited from QWidget
+  virtual void wheelEvent(QWheelEvent *event); // inherited from QWidget
+
+private:
+  boost::shared_ptr<ImageTexture> texture;
+  bool    fitToWindow;
+  double  zoomFactor; // screen pixels per image pixel
+  QPointF offset; // image position at the top left corner of the widget
+  QPoint  lastMouse;
+};
+
+} // namespace
+
+#endif // GUI3DQT_IMAGEVIEW_HPP_
@@ -28,8 +28,12 @@
 #define GUI3DQT_MNAVWIDGET_HPP_
 
 #include <QtWidgets/QWidget>
+#include <vector>
 #include <QtOpenGL/QGLWidget>
+#include <QtOpenGL/QGLBuffer>
+#include <QtOpenGL/QGLFramebufferObject>
 #include <boost/function.hpp>
+#include "GLState.hpp"
 
 namespace Gui3DQt {
   
@@ -42,6 +46,9 @@ namespace Gui3DQt {
   - nice 3D mouse navigation
   - 2D/3D switching context
   - registration of user-defined paint functions which are called when a repaint is initiated
+  - asynchronous frame grabbing via a ring of pixel buffer objects
+  - offscreen rendering of single frames, e.g. for rendering videos faster than real time
+  - a shadow copy of the GL state (GLState), current while painting
 */
 class MNavWidget : public QGLWidget
 {
@@ -57,6 +64,7 @@ public:
     virtual QSize minimumSizeHint() const; // inherited from QWidget
     virtual QSize sizeHint() const; // inherited from QWidget
 
+    void setUserPreparePaint(boost::function<void()> func); //!< If registered, this function is called before the camera is set up and the paint functions are called (e.g. for CPU-side preparations)
     void setUserPaintGLTranslucent(boost::function<void()> func); //!< If registered, this function is called after enabling "transparent" mode
     void setUserPaintGLOpaque(boost::function<void()> func); //!< If registered, this function is called after enabling "opoaque" mode
     void setUserAfterPaint(boost::function<void()> func); //!< If registered, this function is called after rendering is finished (e.g. for frame grabbing etc)
@@ -73,6 +81,17 @@ public:
     void recenter_2D(void);
     void pick_point(int mouse_x, int mouse_y, double *scene_x, double *scene_y);
     void get_2D_position(int x, int y, double *xout, double *yout);
+
+    void setAsyncGrabDepth(unsigned int nbFrames); //!< Number of frames that can be in flight during asynchronous grabbing (>=2), i.e. frames are returned nbFrames-1 paints later
+    bool grabFrameBufferAsync(QImage &frame); //!< Queues the readback of the current frame. Returns true if an earlier frame became available in frame. Call from within the after-paint function
+    bool finishFrameBufferAsync(QImage &frame); //!< Returns the remaining queued frames one by one, false if none is left. Call when grabbing stops
+
+    void setUserFrameSink(boost::function<void(const QImage&)> func); //!< If registered, this function receives the frames of renderFrameToSink(). An empty image marks the end of a sequence
+    bool renderOffscreen(QImage &frame, int width = 0, int height = 0); //!< Renders the scene with the current camera into an offscreen buffer, by default with the widget's size. Does not call the after-paint function
+    bool renderFrameToSink(); //!< Renders offscreen and passes the frame to the frame sink. Returns false if nothing was rendered
+    void endFrameSequence(); //!< Passes an empty image to the frame sink
+
+    GLState& getGLState(); //!< State tracker of this widget's context, same as GLState::current() while painting
     
 protected: // access only by derived classes
     virtual void initializeGL(); // inherited from QGLWidget
@@ -85,9 +104,26 @@ protected: // access only by derived classes
 
 private:
 
+    boost::function<void()> userPreparePaint;
     boost::function<void()> userPaintGLTranslucent;
     boost::function<void()> userPaintGLOpaque;
     boost::function<void()> userAfterPaint;
+    boost::function<void(const QImage&)> userFrameSink;
+    bool glInitialized;
+    GLState glState;
+
+    std::vector<QGLBuffer*> grabBuffers; // ring of pixel buffer objects for asynchronous readback
+    std::vector<QSize> grabSizes; // frame size stored in each ring buffer
+    unsigned int grabDepth;
+    unsigned int grabHead; // index of the next buffer to read into
+    unsigned int grabPending; // number of buffers holding frames not returned yet
+    bool createGrabBuffers();
+    void destroyGrabBuffers();
+    bool readGrabBuffer(QImage &frame); // maps the oldest pending buffer and copies it into frame
+
+    QGLFramebufferObject *offscreenBuffer; // reused as long as the requested size does not change
+    void renderScene(int width, int height); // sets up the camera and calls the user paint functions
+    void setDefaultState(); // sets the state the paint functions start with, regardless of the cached values
     
     void rotate_camera(double dx, double dy);
     void zoom_camera(double dy);
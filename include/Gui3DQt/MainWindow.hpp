@@ -32,11 +32,14 @@
 
 #include <QtWidgets/QMainWindow>
 #include <QtWidgets/QBoxLayout>
-#include <QScrollBar>
 #include <QGroupBox>
 
 #include "Visualizer.hpp"
 #include "MNavWidget.hpp"
+#include "ImageView.hpp"
+#include "ImageStream.hpp"
+#include "FrameWriter.hpp"
+#include "WorkerPool.hpp"
 
 namespace Ui { class MainWindowClass; } // forward declaration to avoid including the ui_ header
 
@@ -63,8 +66,12 @@ public:
 
   void                    registerVisualizer(Visualizer*, std::string title, VisualizerMode vMode = VM_Groupbox, bool active = true); //!< called from extern to register a new Visualizer (add to GUI and call their paint methods on redraws)
   MNavWidget*             getMNavWidget();
+  ImageStream*            get2DImageStream(); //!< for video-rate images from other threads, stale frames are dropped (alternative to Visualizer::redraw2D)
   
   void                    setImageOutputDir(std::string dir);
+  void                    setImageFormat(FrameWriter::Format format);
+  void                    setGrabQueuePolicy(FrameWriter::QueuePolicy policy);
+  void                    setGrabSink(FrameWriter::Sink sink);
   void                    setControlPanelVisible(bool);
   void                    setGrabbingActive(bool);
 
@@ -77,23 +84,28 @@ private:
   QBoxLayout              *controlLayout; // current Vertical Layout
   MNavWidget              *glWid;
   const GuiMode           guiMode;
+  ImageView               *imageView; // 2D tab
+  ImageView               *imagePreview; // below the tabs
+  bool                    previewSharesImage; // if false, the image is uploaded to both views
+  ImageStream             *imageStream;
   QImage                  image2D;
+  RawImage                raw2D; // set instead of image2D for native camera formats
   unsigned int            addedWidgets;
-  float                   currImgScaleFactor;
-  void                    setScaledImage(float factor);
-  void                    adjustScrollBar(QScrollBar *scrollBar, double factor);
   
   // Grabbing:
   boost::filesystem::path imageOutputDirectory;
   std::string             imageFilePattern;
-  unsigned int            frameCounter;
+  FrameWriter             *frameWriter;
   bool                    grabFrames;
   bool                    grabSingleFrame;
-  std::string             getCurrentOutputFilename();
+  void                    saveFrame(const QImage &frame); // hands frame to the frame writer, which stores it in the background (single shots always as image file)
+  void                    saveRenderedFrame(const QImage &frame); // called by QGlMNavWidget for offscreen rendered frames, never drops a frame
 
   // Drawing:
   typedef std::pair<Visualizer*,QGroupBox*> VisGroupbox;
   std::list<VisGroupbox>  visualizers;
+  WorkerPool              *workerPool; // runs prepare() of the visualizers
+  void                    preparePaint(); // called by QGlMNavWidget before painting, calls prepare() of all active visualizers concurrently
   void                    paintGLOpaque(); // called by QGlMNavWidget during painting, calls itself respective method of all visualizers
   void                    paintGLTranslucent(); // called by QGlMNavWidget during painting, calls itself respective method of all visualizers
   void                    afterGLPaint(); // called by QGlMNavWidget after painting is finished
@@ -101,6 +113,7 @@ private:
 
 private slots:
   void                    set2DImage(QImage&);
+  void                    set2DImage(const Gui3DQt::RawImage&);
   void                    viewChanged(int);
 
   void                    changeView2D3D();
@@ -112,6 +125,10 @@ private slots:
 
   void                    setImageOutputDir();
   void                    setImageFilePattern();
+  void                    setImageFormat(QAction *action);
+  void                    setGrabQueuePolicy(QAction *action);
+  void                    setGrabSink(QAction *action);
+  void                    setEncoderCommand();
   void                    startStopGrabbing(bool grab);
   void                    startSingleGrab();
 };
@@ -0,0 +1,85 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   ModelAssets.hpp
+ *  \brief  Loads the built-in 3d models once and shares them between their users
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_MODELASSETS_HPP_
+#define GUI3DQT_MODELASSETS_HPP_
+
+#include <iostream>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace Gui3DQt {
+
+class IndexedModel;
+class WorkerPool;
+
+/*!
+  \class ModelAssets
+  \brief Manages the built-in vehicle models (used by PassatModel and FleetRenderer)
+
+  Preparing a model (reading it and generating its levels of detail) is done
+  once, either in background threads after preload() or on the first get().
+  The models are shared by reference-counted pointers, their vertex and index
+  buffers are created on the first draw and freed with the last reference
+  (the GL context must be current then).
+  preload() should be called at startup, so that the first paint does not wait.
+*/
+class ModelAssets
+{
+public:
+  enum Asset { PASSAT = 0, TIRE, VELODYNE, NB_ASSETS };
+  static const int NB_LODS = 4; //!< level 0 is the full model, the others are simplified
+
+  static ModelAssets& instance();
+  static int levelOfDetail(double pixels); //!< level to draw a vehicle with, by its projected length in pixels
+
+  void    preload(bool wait = false); //!< starts preparing all models in background threads (no GL calls), optionally waits until they are done
+  boost::shared_ptr<IndexedModel> get(Asset asset, int lod = 0); //!< waits until the model is prepared (or prepares it in the calling thread), NULL if it could not be loaded
+  void    release(Asset asset); //!< drops the references held by the manager, the model is prepared again on the next get()
+  size_t  gpuMemory(Asset asset) const; //!< bytes in vertex and index buffers of all levels of detail
+  size_t  gpuMemory() const; //!< sum over all assets
+  void    printReport(std::ostream &out = std::cout) const; //!< state, triangles, GPU memory and number of users of each asset
+
+private:
+  enum State { NOT_PREPARED, PREPARING, READY, FAILED };
+  struct Entry {
+    State state;
+    std::vector< boost::shared_ptr<IndexedModel> > lods;
+  };
+
+  mutable boost::mutex mutex; // protects entries and pool
+  boost::condition_variable prepared;
+  Entry       entries[NB_ASSETS];
+  WorkerPool *pool; // created by the first preload()
+
+  ModelAssets();
+  ~ModelAssets();
+  void        prepare(Asset asset); // loads the model and generates its levels of detail
+};
+
+} // namespace
+
+#endif // GUI3DQT_MODELASSETS_HPP_
@@ -0,0 +1,85 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   ObjectListRenderer.hpp
+ *  \brief  Draws lists of tracked objects (boxes, velocities, uncertainties, labels)
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_OBJECTLISTRENDERER_HPP_
+#define GUI3DQT_OBJECTLISTRENDERER_HPP_
+
+#include <vector>
+#include <GL/gl.h>
+#include "ShapeInstances.hpp"
+#include "TextBatch.hpp"
+
+namespace Gui3DQt {
+
+/*!
+  \class ObjectListRenderer
+  \brief Draws a list of tracked objects with few draw calls
+
+  Replacement of Graphics::draw_observed_car() for many objects:
+  setObjects() converts all objects into instances of unit shapes (box fill,
+  box outline with heading line, velocity arrow, position uncertainty ellipse)
+  and formats the labels into a TextBatch. render() only sets up the OpenGL
+  state once and draws every shape type with one instanced call and all
+  labels with one textured quad batch.
+  The data is only processed again on the next call of setObjects().
+*/
+class ObjectListRenderer
+{
+public:
+  struct Object {
+    Object() : x(0), y(0), theta(0), width(0), length(0), velocity(0), xVar(0), yVar(0), id(0), confidence(0), published(false), showLabel(false) {};
+    double  x, y, theta; //!< pose of the box center
+    double  width, length;
+    double  velocity; //!< in direction of theta, in m/s
+    double  xVar, yVar; //!< variance of the position
+    int     id;
+    double  confidence; //!< shown in red above the box center if showLabel is set
+    bool    published; //!< drawn in green instead of white
+    bool    showLabel; //!< draw confidence, id, position, velocity and direction as draw_observed_car()
+  };
+
+  ObjectListRenderer();
+  virtual ~ObjectListRenderer(); //!< the GL context must be current if render() was called
+
+  void    setObjects(const std::vector<Object> &objects); //!< replaces the displayed objects
+  void    clear();
+  size_t  size() const;
+  void    setVelocityScale(double seconds); //!< length of the velocity arrows: distance travelled in this time, default 1s
+  void    setLabelSize(double size); //!< height of the label text in m
+
+  void    render(); //!< call from within a paint function
+
+private:
+  ShapeInstances shapes;
+  int         boxFill, boxOutline, heading, arrowShaft, arrowHead, ellipse;
+  TextBatch   labels;
+  std::vector<Object> objects;
+  double      velocityScale;
+
+  void        buildShapes();
+};
+
+} // namespace
+
+#endif // GUI3DQT_OBJECTLISTRENDERER_HPP_
@@ -0,0 +1,97 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   PrimitiveBatch.hpp
+ *  \brief  Records many simple shapes into vertex buffers and draws them with few calls
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_PRIMITIVEBATCH_HPP_
+#define GUI3DQT_PRIMITIVEBATCH_HPP_
+
+#include <vector>
+#include <GL/gl.h>
+#include <QtOpenGL/QGLBuffer>
+
+namespace Gui3DQt {
+
+/*!
+  \class PrimitiveBatch
+  \brief Retained counterpart of the draw_* functions in graphics.hpp
+
+  Shapes are recorded with the current color into CPU-side vertex lists
+  (filled shapes as triangles, outlines as line segments). render() uploads
+  them into a vertex buffer object if something changed and draws all
+  triangles, lines and points with one call each.
+  A visualizer typically rebuilds its batch only when its data changes
+  (e.g. in prepare(), as recording issues no OpenGL calls) and calls render()
+  in every paint.
+  2D shapes are placed at z=0 unless z is given.
+*/
+class PrimitiveBatch
+{
+public:
+  PrimitiveBatch();
+  virtual ~PrimitiveBatch(); //!< the GL context must be current if render() was called
+
+  void    clear(); //!< removes all shapes, keeps the allocated memory
+  bool    empty() const;
+  void    setColor(float r, float g, float b, float a = 1.0f); //!< color of the following shapes, 0..1 as in glColor
+  void    setLineWidth(float width); //!< for all lines of the batch
+  void    setPointSize(float size); //!< for all points of the batch
+
+  void    point(double x, double y, double z = 0);
+  void    line(double x1, double y1, double x2, double y2, double z = 0);
+  void    line3D(double x1, double y1, double z1, double x2, double y2, double z2);
+  void    dashedLine(double x1, double y1, double x2, double y2, double stripe_len, double z = 0);
+  void    circle(double x, double y, double r, bool filled, double z = 0);
+  void    ellipse(double x, double y, double rx, double ry, bool filled, double z = 0);
+  void    diamond(double x, double y, double r, double z = 0);
+  void    arrow(double x1, double y1, double x2, double y2, double head_width, double head_length, double z = 0);
+  void    arrowhead(double x, double y, double angle, double z = 0);
+  void    boundingBox(double x, double y, double theta, double w, double l, double z = 0); //!< filled rectangle with outline and heading line
+  void    cubeSolid(float x1, float x2, float y1, float y2, float z1, float z2);
+  void    cubeCage(float x1, float x2, float y1, float y2, float z1, float z2);
+
+  void    render(); //!< uploads changes and draws the batch, call from within a paint function
+
+private:
+  struct Vertex {
+    GLfloat x, y, z;
+    GLubyte r, g, b, a;
+  };
+
+  std::vector<Vertex> triangles;
+  std::vector<Vertex> lines;
+  std::vector<Vertex> points;
+  Vertex      color; // only color is used
+  float       lineWidth;
+  float       pointSize;
+  bool        dirty; // vertex lists differ from the buffer content
+  QGLBuffer   buffer; // triangles, lines and points in this order
+  GLsizei     bufferCapacity; // in vertices
+  GLsizei     nbTriangleVertices, nbLineVertices, nbPointVertices; // uploaded counts
+
+  void        addVertex(std::vector<Vertex> &list, double x, double y, double z);
+  void        upload();
+};
+
+} // namespace
+
+#endif // GUI3DQT_PRIMITIVEBATCH_HPP_
@@ -0,0 +1,80 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   RawImage.hpp
+ *  \brief  Describes camera images in their native pixel format (grayscale, Bayer, depth)
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_RAWIMAGE_HPP_
+#define GUI3DQT_RAWIMAGE_HPP_
+
+#include <QImage>
+#include <QMetaType>
+#include <boost/shared_array.hpp>
+
+namespace Gui3DQt {
+
+/*!
+  \struct RawImage
+  \brief Image in a camera's native pixel format, displayed by ImageView without CPU conversion
+
+  The pixel data is shared (not copied) when a RawImage is copied, so it can
+  be passed through queued signals cheaply. The producer must not modify the
+  data after handing it over.
+  Debayering, normalization to [rangeMin,rangeMax] and depth colormapping are
+  done by a fragment shader. toQImage() does the same on the CPU, e.g. for
+  grabbing or if shaders are not available.
+*/
+struct RawImage
+{
+  enum PixelFormat {
+    PF_Gray8,       //!< unsigned char per pixel
+    PF_Gray16,      //!< unsigned short per pixel (host byte order)
+    PF_BayerRGGB8,  //!< unsigned char per pixel, first row starts with R,G
+    PF_BayerBGGR8,  //!< unsigned char per pixel, first row starts with B,G
+    PF_BayerGRBG8,  //!< unsigned char per pixel, first row starts with G,R
+    PF_BayerGBRG8,  //!< unsigned char per pixel, first row starts with G,B
+    PF_Depth32F     //!< float per pixel, displayed with a jet colormap, values <= 0 and NaN are shown black
+  };
+
+  PixelFormat   format;
+  int           width;
+  int           height;
+  int           stride; //!< bytes per row, must be a multiple of the pixel size
+  boost::shared_array<unsigned char> data;
+  float         rangeMin; //!< value displayed black (gray) or blue (depth)
+  float         rangeMax; //!< value displayed white (gray) or red (depth)
+
+  RawImage() : format(PF_Gray8), width(0), height(0), stride(0), rangeMin(0), rangeMax(255) {};
+  RawImage(PixelFormat fmt, int w, int h); //!< allocates the pixel data with a tight stride, range is set to the full value range (depth: 0..50)
+
+  bool          isNull() const {return !data || (width <= 0) || (height <= 0);};
+  int           bytesPerPixel() const;
+  bool          isBayer() const;
+  unsigned char* scanLine(int y) {return data.get() + y*stride;};
+  const unsigned char* constScanLine(int y) const {return data.get() + y*stride;};
+  QImage        toQImage() const; //!< converts on the CPU
+};
+
+} // namespace
+
+Q_DECLARE_METATYPE(Gui3DQt::RawImage)
+
+#endif // GUI3DQT_RAWIMAGE_HPP_
@@ -0,0 +1,104 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   ShapeInstances.hpp
+ *  \brief  Draws many transformed copies of 2D unit shapes with instancing
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_SHAPEINSTANCES_HPP_
+#define GUI3DQT_SHAPEINSTANCES_HPP_
+
+#include <vector>
+#include <GL/gl.h>
+#include <QtOpenGL/QGLBuffer>
+
+class QGLShaderProgram;
+
+namespace Gui3DQt {
+
+namespace Instancing { struct Functions; }
+
+/*!
+  \class ShapeInstances
+  \brief Instanced drawing of many copies of 2D unit shapes
+
+  Unit shapes (e.g. a unit circle, a unit box) are registered once with
+  addShape() and stored in a vertex buffer. Each instance only stores its
+  position, orientation, scale in x and y, and color. render() draws all
+  instances of a shape with one instanced draw call, transforming the unit
+  shape in a vertex shader. If instancing is not supported by the OpenGL
+  implementation, the unit shape is drawn once per instance with the matrix
+  stack instead.
+*/
+class ShapeInstances
+{
+public:
+  ShapeInstances();
+  virtual ~ShapeInstances(); //!< the GL context must be current if render() was called
+
+  /*! registers a unit shape given as 2D vertices (x0,y0,x1,y1,...) drawn with mode, e.g. GL_TRIANGLE_FAN or GL_LINES
+   *  \return the id to be used with addInstance() */
+  int     addShape(GLenum mode, const std::vector<GLfloat> &xy);
+  void    clear(); //!< removes all instances, keeps the shapes and the allocated memory
+  size_t  size() const; //!< number of instances of all shapes
+  void    reserve(int shape, size_t nbInstances);
+  void    setColor(float r, float g, float b, float a = 1.0f); //!< color of the following instances, 0..1 as in glColor
+  void    setLineWidth(float width); //!< for all line shapes
+  void    addInstance(int shape, double x, double y, double theta, double sx, double sy, double z = 0); //!< shape vertex (u,v) is drawn at (x,y,z) + R(theta)*(sx*u,sy*v)
+
+  void    render(); //!< uploads changes and draws all instances, call from within a paint function
+
+private:
+  struct Instance {
+    GLfloat x, y, z, theta;
+    GLfloat sx, sy;
+    GLubyte r, g, b, a;
+  };
+  struct Shape {
+    GLenum  mode;
+    GLint   first; // in the unit mesh
+    GLsizei count;
+    std::vector<Instance> instances;
+    GLsizei firstInstance, nbInstances; // in the instance buffer
+  };
+
+  std::vector<Shape> shapes;
+  std::vector<GLfloat> mesh; // all unit shapes
+  Instance      color; // only color is used
+  float         lineWidth;
+  bool          meshDirty; // shapes were added since the last upload
+  bool          dirty; // instances differ from the buffer content
+  bool          initialized; // instancing support determined
+  QGLBuffer     meshBuffer;
+  QGLBuffer     instanceBuffer; // instances of all shapes in order
+  GLsizei       instanceCapacity;
+  QGLShaderProgram *program; // NULL if instancing is not available
+  Instancing::Functions *instancing; // entry points for instanced drawing
+
+  void          initialize();
+  void          uploadMesh();
+  void          uploadInstances();
+  void          renderInstanced(const Shape &shape);
+  void          renderLoop(const Shape &shape);
+};
+
+} // namespace
+
+#endif // GUI3DQT_SHAPEINSTANCES_HPP_
@@ -0,0 +1,111 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   TextBatch.hpp
+ *  \brief  Draws many strings from a glyph atlas texture with one draw call
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_TEXTBATCH_HPP_
+#define GUI3DQT_TEXTBATCH_HPP_
+
+#include <string>
+#include <vector>
+#include <GL/gl.h>
+#include <QFont>
+#include <QImage>
+#include <QtOpenGL/QGLBuffer>
+
+class QGLShaderProgram;
+
+namespace Gui3DQt {
+
+/*!
+  \class TextBatch
+  \brief Text rendering for many labels
+
+  Printable ASCII glyphs of a font are rasterized once into an atlas texture
+  (when the first string is added or drawn, so a TextBatch can be created before
+  the QApplication).
+  Added strings are converted into textured quads which are drawn with one
+  call in render(), as opposed to the GLUT functions in graphics.hpp which
+  draw every character separately.
+  Each string is anchored at a 3D point (left end of the baseline of the
+  first line, '\\n' starts a new line below). In world space mode the text
+  lies in the x-y plane and its size is given in world units, in screen
+  space mode it faces the viewer and its size is given in pixels,
+  independent of the distance to the camera.
+*/
+class TextBatch
+{
+public:
+  TextBatch(const QFont &font = QFont("Sans", 24)); //!< the font size determines the rasterization quality, not the displayed size
+  virtual ~TextBatch(); //!< the GL context must be current if render() was called
+
+  void    clear(); //!< removes all strings, keeps the allocated memory
+  bool    empty() const;
+  void    setColor(float r, float g, float b, float a = 1.0f); //!< color of the following strings, 0..1 as in glColor
+  void    setScreenSpace(bool screenSpace); //!< switches between size in world units (default) and in pixels, for all strings
+  void    setSize(double lineHeight); //!< height of a text line in world units or pixels, for all strings, default 1
+  void    add(double x, double y, double z, const std::string &text, bool centered = false); //!< centered: anchor at the horizontal center instead of the left end
+  double  textWidth(const std::string &text) const; //!< width of the longest line, relative to the line height
+
+  void    render(); //!< uploads changes and draws all strings, call from within a paint function
+
+private:
+  struct Glyph {
+    GLfloat s0, t0, s1, t1; // texture coordinates
+    GLfloat width; // quad width and advance, relative to the line height
+  };
+  struct Vertex {
+    GLfloat x, y, z; // anchor
+    GLfloat ox, oy; // offset from the anchor, relative to the line height
+    GLfloat s, t;
+    GLubyte r, g, b, a; // premultiplied by alpha
+  };
+
+  QFont       font;
+  mutable bool rasterized; // atlas and glyphs are created on first use, QFontMetrics needs the QApplication
+  mutable QImage atlas;
+  mutable Glyph glyphs[95]; // characters 32..126, all others are drawn as ?
+  mutable GLfloat descent; // relative to the line height
+  std::vector<Vertex> vertices; // 4 per character
+  GLubyte     color[4];
+  bool        screenSpace;
+  double      size;
+  bool        dirty; // vertices differ from the buffer content
+  bool        initialized; // atlas uploaded, program created
+  GLuint      texture;
+  QGLBuffer   buffer;
+  GLsizei     bufferCapacity; // in vertices
+  GLsizei     nbVertices; // uploaded count
+  QGLShaderProgram *program; // NULL if shaders are not available
+  std::vector<GLfloat> positions; // computed on the CPU without shaders
+
+  void        rasterize() const;
+  const Glyph& glyph(char c) const;
+  void        initialize();
+  void        upload();
+  void        renderShader();
+  void        renderFixedFunction();
+};
+
+} // namespace
+
+#endif // GUI3DQT_TEXTBATCH_HPP_
@@ -0,0 +1,97 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   TripleBuffer.hpp
+ *  \brief  Provides a lock-free handoff of data from a producer thread to the renderer
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_TRIPLEBUFFER_HPP_
+#define GUI3DQT_TRIPLEBUFFER_HPP_
+
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace Gui3DQt {
+
+/*!
+  \class TripleBuffer
+  \brief Passes snapshots of T from one writer thread to one reader thread without locks
+
+  The writer fills writeBuffer() and calls publish(), which never waits.
+  The reader calls update() at the beginning of a frame and then uses
+  readBuffer(), which stays unchanged until the next update(), no matter how
+  often the writer publishes in the meantime. Snapshots that were published
+  but never read are silently overwritten, i.e. the reader always gets the
+  newest complete one.
+
+  The three buffers are recycled: after publish(), writeBuffer() refers to an
+  older snapshot, so the writer must overwrite all of its content (containers
+  keep their capacity, so no reallocation happens in the steady state).
+
+  Usage within a Visualizer:
+  \code
+    // sensor thread:
+    std::vector<Point> &pts = buffer.writeBuffer();
+    pts.assign(scan.begin(), scan.end());
+    buffer.publish();
+    emit stateChanged();
+    // paintGLOpaque():
+    buffer.update();
+    const std::vector<Point> &pts = buffer.readBuffer();
+  \endcode
+*/
+template <class T>
+class TripleBuffer : private boost::noncopyable
+{
+public:
+  TripleBuffer() : back(0), front(1), state(2) {};
+  explicit TripleBuffer(const T &init) : back(0), front(1), state(2) {
+    buffers[0] = init; buffers[1] = init; buffers[2] = init;
+  };
+
+  T&        writeBuffer() {return buffers[back];}; //!< writer only: buffer to fill before publish()
+  void      publish() { //!< writer only: makes the write buffer the newest snapshot, never blocks
+    unsigned int old = state.exchange(back | FRESH, boost::memory_order_acq_rel);
+    back = old & INDEX;
+  };
+  void      publish(const T &value) {writeBuffer() = value; publish();}; //!< writer only: copies value and publishes it
+
+  bool      hasUpdate() const {return (state.load(boost::memory_order_relaxed) & FRESH) != 0;}; //!< true if a snapshot was published since the last update()
+  bool      update() { //!< reader only: switches to the newest snapshot, returns false if there was no new one
+    if (!hasUpdate())
+      return false;
+    unsigned int old = state.exchange(front, boost::memory_order_acq_rel);
+    front = old & INDEX;
+    return true;
+  };
+  const T&  readBuffer() const {return buffers[front];}; //!< reader only: snapshot selected by the last update()
+  T&        readBuffer() {return buffers[front];};
+
+private:
+  enum { INDEX = 3, FRESH = 4 };
+  T                           buffers[3];
+  unsigned int                back;  // only accessed by the writer
+  unsigned int                front; // only accessed by the reader
+  boost::atomic<unsigned int> state; // index of the buffer in between and FRESH flag
+};
+
+} // namespace
+
+#endif // GUI3DQT_TRIPLEBUFFER_HPP_
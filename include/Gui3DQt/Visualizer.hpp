@@ -30,6 +30,8 @@
 #include <QColor>
 #include <GL/glut.h>
 
+#include "RawImage.hpp"
+
 namespace Gui3DQt {
   
 /*!
@@ -46,8 +48,14 @@ namespace Gui3DQt {
  * 		Usw Qt Designer to create your front end, and implement your own paintGL function.
  * As an example see VisualizerGrid.h/.cpp
  * 
+ * CPU-intensive work (colorization, tessellation, text layout, ...) should be done in prepare().
+ * MainWindow calls prepare() of all active visualizers concurrently in a WorkerPool before
+ * each paint, so the paint methods only have to submit the prepared data to OpenGL.
+ * 
  * ATTENTION: If you derive from Visualizer, there might be exceptions if you pass 2 pointers as parameter in the constructor!!!
- * ATTENTION: If your visualizer accesses data structures from other threads, don't forget to synchronize with mutex variables!  
+ * ATTENTION: If your visualizer accesses data structures from other threads, don't forget to synchronize!
+ *            Prefer TripleBuffer over mutex variables: then neither the producing thread nor the painting blocks.
+ * ATTENTION: prepare() runs in a worker thread: no OpenGL calls and no access to Qt widgets there!
  */
 class Visualizer : public QWidget
 {
@@ -56,6 +64,7 @@ public:
   Visualizer(QWidget *parent = 0) : QWidget(parent) {};
 	virtual ~Visualizer() {};
 	
+	virtual void prepare() {}; //!< will be called before rendering, possibly in a worker thread concurrently to other visualizers. do CPU-side computations here, no OpenGL calls
 	virtual void paintGLOpaque() = 0; //!< will be called on rendering. use OpenGL calls here. can be used to draw opaque objects
   virtual void paintGLTranslucent() = 0; //!< will be called on rendering. use OpenGL calls here. can be used to draw transparent objects
 	
@@ -81,7 +90,8 @@ public:
 
 signals:
 	void stateChanged(); //!< emit this signal when state of the visualizer changes and thus a GL redraw is necessary (in return the above paintGL methods will be called)
-  void redraw2D(QImage&); //!< emit this signal to redraw the 2D image
+  void redraw2D(QImage&); //!< emit this signal to redraw the 2D image. for video-rate images from other threads use MainWindow::get2DImageStream() instead
+  void redraw2D(const Gui3DQt::RawImage&); //!< emit this signal to redraw the 2D image with an image in a native camera format (converted on the GPU)
 };
 
 } // namespace
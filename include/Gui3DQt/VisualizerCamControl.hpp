@@ -53,6 +53,7 @@ public:
   virtual void paintGLTranslucent() {};
 
   void loadCamBuff(std::string filename);
+  unsigned int renderFlight(unsigned int startIdx, unsigned int endIdx, unsigned int nbFrames, bool spline = true); //!< renders the flight between the given buffer positions (0-based, backwards if endIdx < startIdx) offscreen, pose by pose, as fast as possible. Frames are passed to the frame sink of the MNavWidget. Returns the number of rendered frames. Throws range_error for equal or invalid positions or less than 2 frames
   
 private:
 //  struct CamPos {
@@ -79,6 +80,8 @@ private:
   QTimer *pilot;
   QString lastFilePath;
 
+  void generateTrajectory(); // generates trajectory according to the settings in the GUI
+  unsigned int renderTrajectory(); // renders all poses of trajectory offscreen
   void generateLinearTrajectory(unsigned int startIdx, unsigned int endIdx, unsigned int trajSize);
   void generateSplineTrajectory(unsigned int startIdx, unsigned int endIdx, unsigned int trajSize);
   void updateSlider(); // update slider in case camPositions buffer changed
@@ -102,6 +105,7 @@ private slots:
   void setStartPos();
   void setEndPos();
   void fly(bool down);
+  void renderFlight();
 
   void flyToNextPos();
 
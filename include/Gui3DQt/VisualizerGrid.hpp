@@ -27,10 +27,21 @@
 #define GUI3DQT_VISUALIZERGRID_HPP_
 
 #include <QtWidgets/QWidget>
+#include <QtOpenGL/QGLBuffer>
 #include "Visualizer.hpp"
+#include "CoordinateFrameInstances.hpp"
 
 namespace Gui3DQt {
   
+/*!
+ * \class VisualizerGrid
+ * \brief Draws a grid in the horizontal plane and a coordinate frame at its center
+ *
+ * The grid lines are stored once in a vertex buffer. Each frame the line spacing is
+ * chosen by the height of the camera above the plane (a power of 10, with every 10th line
+ * emphasized and the finer lines fading out when zooming out), and the grid is centered
+ * below the camera. Thus it covers the view at any zoom level, also for km-scale maps.
+ */
 class VisualizerGrid : public Visualizer
 {
   Q_OBJECT
@@ -47,6 +58,10 @@ public:
 
 private:
   double x, y, z, yawRad; // position of center
+  QGLBuffer gridMesh; // unit grids with spacing 1: fine lines followed by coarse lines
+  CoordinateFrameInstances frame; // at the center
+
+  void initGL();
 private slots:
   void update();
 };
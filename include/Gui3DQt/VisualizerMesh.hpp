@@ -0,0 +1,93 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   VisualizerMesh.hpp
+ *  \brief  A visualizer module drawing large indexed triangle meshes
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_VISUALIZERMESH_HPP_
+#define GUI3DQT_VISUALIZERMESH_HPP_
+
+#include <map>
+#include <vector>
+#include <GL/gl.h>
+#include <QtWidgets/QWidget>
+#include <boost/thread/mutex.hpp>
+#include "Visualizer.hpp"
+
+namespace Gui3DQt {
+
+/*!
+ * \class VisualizerMesh
+ * \brief Draws triangle meshes (e.g. reconstructed surfaces) from vertex and index buffers
+ *
+ * A mesh consists of sub-meshes with user-defined ids, e.g. one per tile of a reconstruction.
+ * Setting or removing a sub-mesh only uploads that sub-mesh on the next paint, all others
+ * stay in their buffers. Each sub-mesh is drawn with one glDrawElements call.
+ * If a sub-mesh has normals, it is drawn with lighting (light 0 of MNavWidget).
+ *
+ * Sub-meshes can be set from any thread. Call commit() after a set of changes to redraw.
+ */
+class VisualizerMesh : public Visualizer
+{
+  Q_OBJECT
+
+public:
+  struct Submesh {
+    std::vector<GLfloat> vertices; //!< x,y,z per vertex
+    std::vector<GLfloat> normals; //!< nx,ny,nz per vertex, or empty
+    std::vector<GLubyte> colors; //!< r,g,b per vertex, or empty to use the default color
+    std::vector<GLuint>  indices; //!< 3 per triangle
+    void computeNormals(); //!< area-weighted vertex normals from the triangles
+  };
+
+  VisualizerMesh(QWidget *parent = 0);
+  virtual ~VisualizerMesh();
+
+  virtual void paintGLOpaque();
+  virtual void paintGLTranslucent();
+
+  void    setSubmesh(int id, Submesh &mesh); //!< adds or replaces a sub-mesh. The data is taken over by swapping, mesh is empty afterwards. Throws if an index exceeds the vertices
+  void    removeSubmesh(int id);
+  void    clear();
+  void    setColor(float r, float g, float b); //!< default color of sub-meshes without colors, 0..1
+  void    setLighting(bool enable); //!< shading for sub-meshes with normals, enabled by default
+  size_t  nbTriangles() const; //!< number of triangles in all sub-meshes (uploaded and pending)
+
+public slots:
+  void    commit(); //!< triggers a redraw after changes, can be called from any thread
+
+private:
+  struct GpuSubmesh; // vertex and index buffer of a sub-mesh
+
+  mutable boost::mutex mutex; // protects the pending changes and the triangle counts
+  std::map<int, Submesh*> pending; // new data, NULL to remove
+  bool        clearAll; // all sub-meshes are removed before the pending changes are uploaded
+  std::map<int, GpuSubmesh*> submeshes; // only accessed in the paint methods
+  size_t      nbPendingTriangles, nbUploadedTriangles;
+  GLfloat     color[3];
+  bool        lighting;
+
+  void        upload();
+};
+
+} //namespace
+
+#endif // GUI3DQT_VISUALIZERMESH_HPP_
@@ -70,6 +70,7 @@ private:
   double x, y, z, yawRAD; // position of rear axle
   double veloAngleDEG;
   double wheelAngleDEG;
+  int lod; // level of detail chosen in the opaque pass, reused for the translucent parts
   
 private slots:
   void timerAction();
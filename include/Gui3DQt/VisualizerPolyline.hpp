@@ -0,0 +1,110 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   VisualizerPolyline.hpp
+ *  \brief  A visualizer module drawing long, growing trajectories
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_VISUALIZERPOLYLINE_HPP_
+#define GUI3DQT_VISUALIZERPOLYLINE_HPP_
+
+#include <vector>
+#include <GL/gl.h>
+#include <QtWidgets/QWidget>
+#include <QtOpenGL/QGLBuffer>
+#include <boost/thread/mutex.hpp>
+#include "Visualizer.hpp"
+
+namespace Gui3DQt {
+
+/*!
+ * \class VisualizerPolyline
+ * \brief Draws trajectories (tracks) with hundreds of thousands of points
+ *
+ * The points of each track are stored in a vertex buffer which grows by doubling its
+ * capacity. Appended points are uploaded on the next paint without uploading the
+ * previous ones again (except when the buffer grows). Each track is drawn as line strips.
+ *
+ * If a screen-space tolerance is set, each track is drawn from a decimated version
+ * that omits points closer than the tolerance to the previous point. The decimated
+ * versions are kept as append-only index buffers for tolerances of 5cm * 4^k.
+ * The version is chosen per segment of 4096 points by the distance of its bounding box
+ * to the camera, so only the part of a long drive close to the camera is drawn in full.
+ *
+ * Points can be appended from any thread. Call commit() after a set of changes to redraw.
+ */
+class VisualizerPolyline : public Visualizer
+{
+  Q_OBJECT
+
+public:
+  VisualizerPolyline(QWidget *parent = 0);
+  virtual ~VisualizerPolyline();
+
+  virtual void paintGLOpaque();
+  virtual void paintGLTranslucent();
+
+  int     addTrack(float r, float g, float b, float lineWidth = 1); //!< returns the id of the new track, colors are 0..1
+  void    appendPoint(int track, double x, double y, double z);
+  void    clearTrack(int track); //!< removes all points of the track
+  void    setTrackVisible(int track, bool visible);
+  size_t  nbPoints(int track) const;
+  void    setTolerance(double pixels); //!< maximum screen-space error of the decimation, 0 (default) draws all points
+
+public slots:
+  void    commit(); //!< triggers a redraw after changes, can be called from any thread
+
+private:
+  static const int NB_LEVELS = 8; // decimation levels, level 0 contains all points
+  static const int SEGMENT_POINTS = 4096; // points per segment, the level is chosen per segment
+  struct Level {
+    Level() : buffer(QGLBuffer::IndexBuffer), capacity(0), uploaded(0) {}
+    std::vector<GLuint> indices; // of the kept points, without the last point of the track
+    QGLBuffer buffer;
+    GLsizei   capacity, uploaded;
+  };
+  struct Segment {
+    GLfloat   min[3], max[3]; // bounding box
+    GLsizei   first[NB_LEVELS]; // position of the first kept point of the segment in the indices of each level
+  };
+  struct Track {
+    Track() : lineWidth(1), visible(true), buffer(QGLBuffer::VertexBuffer), capacity(0), uploaded(0) {}
+    GLfloat   color[3];
+    float     lineWidth;
+    bool      visible;
+    std::vector<GLfloat> points; // x,y,z
+    std::vector<Segment> segments; // segment s starts at point s*SEGMENT_POINTS
+    QGLBuffer buffer;
+    GLsizei   capacity, uploaded; // in points
+    Level     levels[NB_LEVELS]; // level 0 is unused, the points are drawn directly
+  };
+
+  mutable boost::mutex mutex; // protects all members below
+  std::vector<Track*> tracks;
+  double      tolerance; // in pixels
+
+  void        upload(Track &track);
+  int         selectLevel(const Segment &segment, const GLdouble *modelview, const GLdouble *projection, const GLint *viewport) const;
+  void        draw(Track &track, const GLdouble *modelview, const GLdouble *projection, const GLint *viewport);
+};
+
+} //namespace
+
+#endif // GUI3DQT_VISUALIZERPOLYLINE_HPP_
@@ -0,0 +1,96 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   VisualizerVoxelMap.hpp
+ *  \brief  A visualizer module drawing large voxel maps from merged face meshes
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_VISUALIZERVOXELMAP_HPP_
+#define GUI3DQT_VISUALIZERVOXELMAP_HPP_
+
+#include <map>
+#include <set>
+#include <vector>
+#include <QtWidgets/QWidget>
+#include <boost/thread/mutex.hpp>
+#include "Visualizer.hpp"
+#include "WorkerPool.hpp"
+
+namespace Gui3DQt {
+
+/*!
+ * \class VisualizerVoxelMap
+ * \brief Draws a voxel map (e.g. an occupancy grid) with hundreds of thousands of voxels
+ *
+ * The map is divided into chunks of 32x32x32 voxels. For each chunk a mesh of its visible
+ * faces is generated, where faces between two occupied voxels are removed and adjacent
+ * faces of the same value are merged into larger rectangles (greedy meshing).
+ * Only chunks whose voxels changed are meshed again, in prepare() and distributed over
+ * two worker threads of the map and the calling thread. The meshes are stored in vertex buffers and drawn with one call per chunk.
+ *
+ * Voxels can be set from any thread. Call commit() after a set of changes to redraw.
+ */
+class VisualizerVoxelMap : public Visualizer
+{
+  Q_OBJECT
+
+public:
+  VisualizerVoxelMap(double voxelSize = 0.2, QWidget *parent = 0);
+  virtual ~VisualizerVoxelMap();
+
+  virtual void prepare();
+  virtual void paintGLOpaque();
+  virtual void paintGLTranslucent();
+
+  double        getVoxelSize() const;
+  void          setVoxel(int ix, int iy, int iz, unsigned char value); //!< value 0 is free space, 1..255 is drawn in the palette color
+  void          setVoxelAt(double x, double y, double z, unsigned char value); //!< same in metric coordinates
+  unsigned char getVoxel(int ix, int iy, int iz) const;
+  void          clear();
+  void          setPaletteColor(unsigned char value, int r, int g, int b); //!< r,g,b = 0..255, by default the values are colored from blue (1) to red (255)
+  size_t        nbFaces() const; //!< number of merged faces drawn
+
+public slots:
+  void          commit(); //!< triggers a redraw after changes, can be called from any thread
+
+private:
+  struct ChunkKey {
+    int x, y, z;
+    bool operator<(const ChunkKey &o) const { return (x < o.x) || ((x == o.x) && ((y < o.y) || ((y == o.y) && (z < o.z)))); }
+  };
+  struct ChunkData; // voxels of a chunk
+  struct ChunkMesh; // merged faces of a chunk, and their vertex buffer
+  struct MeshJob;
+
+  const double  voxelSize;
+  mutable boost::mutex mutex; // protects the members below up to dirtyChunks
+  std::map<ChunkKey, ChunkData*> chunks;
+  unsigned char palette[256][3];
+  std::set<ChunkKey> dirtyChunks; // chunks to be meshed again
+  std::map<ChunkKey, ChunkMesh*> meshes; // only accessed by prepare() and the paint methods, which never run concurrently
+  WorkerPool    workers;
+
+  void          markDirty(const ChunkKey &key, int lx, int ly, int lz); // also marks neighbors if the voxel lies on the border
+  static void   meshChunk(MeshJob *job);
+};
+
+} //namespace
+
+#endif // GUI3DQT_VISUALIZERVOXELMAP_HPP_
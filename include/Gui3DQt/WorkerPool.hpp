@@ -0,0 +1,74 @@
+/*!
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \file   WorkerPool.hpp
+ *  \brief  Provides a simple pool of worker threads for CPU-side work
+ *  \date   2026
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GUI3DQT_WORKERPOOL_HPP_
+#define GUI3DQT_WORKERPOOL_HPP_
+
+#include <deque>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include <boost/exception_ptr.hpp>
+
+namespace Gui3DQt {
+
+/*!
+  \class WorkerPool
+  \brief Executes jobs concurrently in a fixed set of threads
+
+  Jobs must not issue OpenGL calls, as the GL context is bound to the GUI thread.
+  If a job throws, the first exception is rethrown by wait() or run().
+*/
+class WorkerPool
+{
+public:
+  typedef boost::function<void()> Job;
+
+  WorkerPool(unsigned int nbThreads = 0); //!< 0 uses one thread per hardware core
+  virtual ~WorkerPool(); //!< waits until all posted jobs are done
+
+  unsigned int size() const; //!< number of worker threads
+  void         post(const Job &job); //!< queues the job and returns immediately
+  void         wait(); //!< waits until all posted jobs are done
+  void         run(const std::vector<Job> &jobs); //!< executes the jobs concurrently, the calling thread participates. Returns when all posted jobs are done
+
+private:
+  mutable boost::mutex    mutex; // protects all members below
+  boost::condition_variable jobAvailable;
+  boost::condition_variable allDone;
+  std::deque<Job>         queue;
+  unsigned int            busyWorkers;
+  bool                    stopping;
+  boost::exception_ptr    error; // first exception thrown by a job
+  boost::thread_group     workers;
+  unsigned int            nbWorkers;
+
+  void                    work(); // thread function of the workers
+  bool                    execute(boost::mutex::scoped_lock &lock); // executes the next job (if any) with the lock released
+};
+
+} // namespace
+
+#endif // GUI3DQT_WORKERPOOL_HPP_
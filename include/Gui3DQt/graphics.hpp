@@ -39,7 +39,7 @@ namespace Graphics {
   void set_display_mode_2D(int w, int h);
   void set_display_mode_3D(int w, int h, float fov, float zNear, float zFar);
   
-  /* draw strings */
+  /* draw strings (character by character, use TextBatch for many labels) */
   void draw_bitmap_string_2D(float x, float y, void *font, char *string) ;
   void draw_bitmap_string_centered_2D(float x, float y, void *font, char *string);
   void draw_bitmap_string_3D(float x, float y, float z, void *font, char *string) ;
@@ -50,7 +50,9 @@ namespace Graphics {
   void draw_stroke_string(void *font, char *string);
   int stroke_string_width(void *font, char *string);
   
-  /* draw other stuff, 2D at z=0 if no z is given */
+  /* draw other stuff, 2D at z=0 if no z is given
+   * (each call is an own glBegin/glEnd, use PrimitiveBatch for drawing many shapes per frame
+   * EllipseInstances for many circles, ellipses or rings and ObjectListRenderer instead of draw_observed_car) */
   void draw_limit(double x, double y, double theta, double v);
   void draw_circle(double x, double y, double r, int filled);
   void draw_ellipse(double x, double y, double rx, double ry, int filled);
@@ -60,6 +62,9 @@ namespace Graphics {
   void draw_line(double x1, double y1, double x2, double y2);
   void draw_dashed_line(double x1, double y1,double x2, double y2,double stripe_len);
   void draw_coordinate_frame(double scale);
+  const double* unit_circle(int segments); // cos/sin of the circle points (x,y interleaved), computed once per number of segments (at least 3), thread-safe
+  void coordinate_frame_arrow(const float **triangle_vertices, const float **triangle_normals, int *nTriangles,
+                              const float **quad_vertices, const float **quad_normals, int *nQuads); // geometry of one arrow of draw_coordinate_frame() along -z (for CoordinateFrameInstances)
   void draw_bounding_box(double x, double y, double theta, double w, double l);
   void draw_nline_flag(double x, double y, double w, double h, int num_lines, char **line, int color, double camera_pan);
   void draw_observed_car(double x, double y, double theta, double w, double l, int id, double v, int draw_flag, double x_var, double y_var, int tracking_state, int lane, double confidence, int published, double camera_pan);
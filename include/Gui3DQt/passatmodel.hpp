@@ -40,18 +40,28 @@
 namespace Gui3DQt {
   namespace PassatModel {
 
-    //! A maximum of this number of passat models can exist with different colors
+    //! A maximum of this number of passat models can exist with different colors (FleetRenderer has no such limit)
     const unsigned int PASSAT_MODEL_COUNT = 12;
     
     //! The following function can be used to explicitly set the color of a specific model
     void setColor(unsigned int model_index, double r, double g, double b);
 
+    //! Parts of the model to draw, translucent parts (e.g. head lights) belong into the translucent paint pass
+    enum DrawPass { ALL_PARTS, OPAQUE_PARTS, TRANSLUCENT_PARTS };
+
+    //! Level of detail (0: full model) for a car centered at x/y/z in the coordinates of the camera published in GLState, chosen by its projected length in pixels
+    int levelOfDetail(double x, double y, double z);
+
     /*! Draws a passat model (with default color if not explicitly specified before)
      *  The geometrical center will be at 0/0/0. To change that, use
      *  glPushMatrix(), glTranslatef(), glRotatef(), draw(), glPopMatrix()
      *  Some default translation parameters are given below
+     *  Distant cars can be drawn with simplified meshes by passing the level chosen by levelOfDetail() as lod.
+     *  When drawing the opaque and translucent parts in separate passes, choose the level once and pass it to both
+     *  The models are shared through ModelAssets, call ModelAssets::instance().preload() at startup
+     *  to avoid waiting for them in the first paint
      */
-    void draw(unsigned int model_index = 0, double wheel_angle_rad = 0., double velodyne_angle_rad = 0.);
+    void draw(unsigned int model_index = 0, double wheel_angle_rad = 0., double velodyne_angle_rad = 0., DrawPass pass = ALL_PARTS, int lod = 0);
 
     const double translate_to_velobase_x = 0.08;
     const double translate_to_velobase_y = 0.0;
@@ -9,6 +9,7 @@ Visit http://www.righthemisphere.com/dexp.htm for updates.
 #endif
 #include <GL/gl.h>
 #include <GL/glu.h>
+#include "models3d.hpp"
 
 typedef struct sample_MATERIAL_t {
  GLfloat ambient[3];
@@ -6796,76 +6797,10 @@ static int material_ref [17][2] = {
 {1,299},
 {5,183}
 };
-void MyMaterial(GLenum mode,GLfloat *f,GLfloat alpha)
+void generate_passat(Gui3DQt::IndexedModel &model)
 {
- GLfloat d[4];
- d[0]=f[0];
- d[1]=f[1];
- d[2]=f[2];
- d[3]=alpha;
- glMaterialfv (GL_FRONT_AND_BACK,mode,d);
+  for (unsigned int i = 0; i < sizeof(materials)/sizeof(materials[0]); ++i)
+    model.addMaterial(materials[i].ambient, materials[i].diffuse, materials[i].specular, materials[i].emission, materials[i].alpha, materials[i].phExp);
+  model.build(face_indicies, sizeof(face_indicies)/sizeof(face_indicies[0]), vertices, normals,
+              material_ref, sizeof(material_ref)/sizeof(material_ref[0]));
 }
-/*
- *  SelectMaterial uses OpenGL commands to define facet colors.
- *
- *  Returns:
- *    Nothing
- */
-void SelectMaterial(int i)
-{
-  //
-  // Define the reflective properties of the 3D Object faces.
-  //
-  glEnd();
-  GLfloat alpha=materials[i].alpha;
-  MyMaterial (GL_AMBIENT, materials[i].ambient,alpha);
-  MyMaterial (GL_DIFFUSE, materials[i].diffuse,alpha);
-  MyMaterial (GL_SPECULAR, materials[i].specular,alpha);
-  MyMaterial (GL_EMISSION, materials[i].emission,alpha);
-  glMaterialf (GL_FRONT_AND_BACK,GL_SHININESS,materials[i].phExp);
-  if(alpha<1.0)
-        {
-         glEnable(GL_BLEND);
-         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-         glColor4f(1,1,1,alpha);
-        }else
-        {
-         glDisable(GL_BLEND);
-        }
-  glBegin(GL_TRIANGLES);
-};
-GLint generate_passat(double passat_r, double passat_g, double passat_b)
-{
- int i;
- int j;
- materials[2].diffuse[0] = passat_r;
- materials[2].diffuse[1] = passat_g;
- materials[2].diffuse[2] = passat_b;
- GLint lid=glGenLists(1);
-        int mcount=0;
-        int mindex=0;
-   glNewList(lid, GL_COMPILE);
-    glBegin (GL_TRIANGLES);
-    for(i=0;i<(signed)(sizeof(face_indicies)/sizeof(face_indicies[0]));i++)
-       {
-      if(!mcount)
-       {
-        SelectMaterial(material_ref[mindex][0]);
-        mcount=material_ref[mindex][1];
-        mindex++;
-       }
-       mcount--;
-       for(j=0;j<3;j++)
-        {
-          int vi=face_indicies[i][j];
-          int ni=face_indicies[i][j+3];//Normal index
-	  //          int ti=face_indicies[i][j+6];//Texture index
-           glNormal3f (normals[ni][0],normals[ni][1],normals[ni][2]);
-	   //           glTexCoord2f(textures[ti][0],textures[ti][1]);
-           glVertex3f (vertices[vi][0],vertices[vi][1],vertices[vi][2]);
-        }
-       }
-    glEnd ();
-   glEndList();
-   return lid;
-};
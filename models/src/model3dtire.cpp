@@ -7,6 +7,7 @@ This file was produced by Deep Exploration Plugin: CPP Export filter.
 #endif
 #include <GL/gl.h>
 #include <GL/glu.h>
+#include "models3d.hpp"
 
 typedef struct sample_MATERIAL_t {
  GLfloat ambient[3];
@@ -6140,64 +6141,10 @@ static int material_ref [3][2] = {
 {1,3877},
 {2,2375}
 };
-void MyTireMaterial(GLenum mode,GLfloat *f,GLfloat alpha)
+void generate_tire(Gui3DQt::IndexedModel &model)
 {
- GLfloat d[4];
- d[0]=f[0];
- d[1]=f[1];
- d[2]=f[2];
- d[3]=alpha;
- glMaterialfv (GL_FRONT_AND_BACK,mode,d);
+  for (unsigned int i = 0; i < sizeof(materials)/sizeof(materials[0]); ++i)
+    model.addMaterial(materials[i].ambient, materials[i].diffuse, materials[i].specular, materials[i].emission, materials[i].alpha, materials[i].phExp);
+  model.build(face_indicies, sizeof(face_indicies)/sizeof(face_indicies[0]), vertices, normals,
+              material_ref, sizeof(material_ref)/sizeof(material_ref[0]));
 }
-/*
- *  SelectTireMaterial uses OpenGL commands to define facet colors.
- *
- *  Returns:
- *    Nothing
- */
-void SelectTireMaterial(int i)
-{
-  //
-  // Define the reflective properties of the 3D Object faces.
-  //
-  glEnd();
-  GLfloat alpha=materials[i].alpha;
-  MyTireMaterial (GL_AMBIENT, materials[i].ambient,alpha);
-  MyTireMaterial (GL_DIFFUSE, materials[i].diffuse,alpha);
-  MyTireMaterial (GL_SPECULAR, materials[i].specular,alpha);
-  MyTireMaterial (GL_EMISSION, materials[i].emission,alpha);
-  glMaterialf (GL_FRONT_AND_BACK,GL_SHININESS,materials[i].phExp);
-  glBegin(GL_TRIANGLES);
-};
-GLint generate_tire()
-{
- unsigned int i;
- int j;
- GLint lid=glGenLists(1);
-	int mcount=0;
-	int mindex=0;
-   glNewList(lid, GL_COMPILE);
-    glBegin (GL_TRIANGLES);
-      for(i=0;i<sizeof(face_indicies)/sizeof(face_indicies[0]);i++)
-       {
-      if(!mcount)
-       {
-        SelectTireMaterial(material_ref[mindex][0]);
-        mcount=material_ref[mindex][1];
-        mindex++;
-       }
-       mcount--;
-       for(j=0;j<3;j++)
-        {
-          int vi=face_indicies[i][j];
-          int ni=face_indicies[i][j+3];//Normal index
-//          int ti=face_indicies[i][j+6];//Texture index
-           glNormal3f (normals[ni][0],normals[ni][1],normals[ni][2]);
-//           glTexCoord2f(tire_textures[ti][0],tire_textures[ti][1]);
-           glVertex3f (vertices[vi][0],vertices[vi][1],vertices[vi][2]);
-        }
-       }
-    glEnd ();
-   glEndList();
-   return lid;
-};
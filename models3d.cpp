@@ -0,0 +1,391 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "models3d.hpp"
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <boost/thread/once.hpp>
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+#include <QtOpenGL/QGLShaderProgram>
+
+#define MODEL_MAGIC   0x4D443347 // "G3DM"
+#define MODEL_VERSION 1
+
+using namespace std;
+
+// resources of a static library have to be registered explicitly (outside of any namespace)
+static void initModelResources()
+{
+  Q_INIT_RESOURCE(models);
+}
+
+namespace Gui3DQt {
+
+IndexedModel::IndexedModel()
+  : vertexBuffer(QGLBuffer::VertexBuffer), indexBuffer(QGLBuffer::IndexBuffer)
+{
+}
+
+IndexedModel::~IndexedModel()
+{
+  vertexBuffer.destroy();
+  indexBuffer.destroy();
+}
+
+int IndexedModel::addMaterial(const GLfloat ambient[3], const GLfloat diffuse[3], const GLfloat specular[3], const GLfloat emission[3], GLfloat alpha, GLfloat shininess)
+{
+  Material m;
+  for (int i = 0; i < 3; ++i) {
+    m.ambient[i] = ambient[i];
+    m.diffuse[i] = diffuse[i];
+    m.specular[i] = specular[i];
+    m.emission[i] = emission[i];
+  }
+  m.ambient[3] = m.diffuse[3] = m.specular[3] = m.emission[3] = alpha;
+  m.shininess = shininess;
+  materials.push_back(m);
+  return materials.size()-1;
+}
+
+void IndexedModel::build(const short (*faces)[9], size_t nbFaces, const GLfloat (*positions)[3], const GLfloat (*normals)[3], const int (*materialRuns)[2], size_t nbMaterialRuns)
+{
+  // material of each face
+  vector<int> faceMaterial(nbFaces, 0);
+  size_t f = 0;
+  for (size_t r = 0; r < nbMaterialRuns; ++r)
+    for (int c = 0; (c < materialRuns[r][1]) && (f < nbFaces); ++c)
+      faceMaterial[f++] = materialRuns[r][0];
+
+  vertices.clear();
+  indices.clear();
+  groups.clear();
+  map<pair<short,short>, GLushort> vertexOf; // position/normal index -> merged vertex
+  for (size_t m = 0; m < materials.size(); ++m) {
+    Group group = {(int)m, (GLsizei)indices.size(), 0};
+    for (f = 0; f < nbFaces; ++f) {
+      if (faceMaterial[f] != (int)m)
+        continue;
+      for (int j = 0; j < 3; ++j) {
+        pair<short,short> key(faces[f][j], faces[f][j+3]);
+        map<pair<short,short>, GLushort>::iterator v = vertexOf.find(key);
+        if (v == vertexOf.end()) {
+          if (vertices.size()/6 > 0xFFFF)
+            throw length_error("IndexedModel: too many vertices for 16bit indices");
+          v = vertexOf.insert(make_pair(key, (GLushort)(vertices.size()/6))).first;
+          vertices.insert(vertices.end(), positions[key.first], positions[key.first]+3);
+          vertices.insert(vertices.end(), normals[key.second], normals[key.second]+3);
+        }
+        indices.push_back(v->second);
+      }
+    }
+    group.count = indices.size() - group.first;
+    if (group.count > 0)
+      groups.push_back(group);
+  }
+  sortGroups();
+}
+
+GLfloat IndexedModel::extent() const
+{
+  if (vertices.empty())
+    return 0;
+  GLfloat lo[3] = {vertices[0], vertices[1], vertices[2]};
+  GLfloat hi[3] = {vertices[0], vertices[1], vertices[2]};
+  for (size_t v = 0; v < vertices.size(); v += 6)
+    for (int i = 0; i < 3; ++i) {
+      lo[i] = min(lo[i], vertices[v+i]);
+      hi[i] = max(hi[i], vertices[v+i]);
+    }
+  return max(hi[0]-lo[0], max(hi[1]-lo[1], hi[2]-lo[2]));
+}
+
+void IndexedModel::simplify(const IndexedModel &source, GLfloat cellSize)
+{
+  materials = source.materials;
+  vertices.clear();
+  indices.clear();
+  groups.clear();
+
+  // cluster vertices by cell and dominant normal axis, so that sharp edges are not smoothed away
+  const size_t nbSourceVertices = source.nbVertices();
+  vector<GLushort> clusterOf(nbSourceVertices);
+  vector<GLfloat> counts;
+  map<int64_t, GLushort> clusters;
+  for (size_t v = 0; v < nbSourceVertices; ++v) {
+    const GLfloat *p = &source.vertices[6*v];
+    int64_t cell = 0;
+    for (int i = 0; i < 3; ++i)
+      cell = (cell << 16) | ((int64_t)floor(p[i]/cellSize) & 0xFFFF);
+    int axis = 0;
+    for (int i = 1; i < 3; ++i)
+      if (fabs(p[3+i]) > fabs(p[3+axis]))
+        axis = i;
+    const int64_t key = (cell << 3) | (2*axis + (p[3+axis] < 0));
+    map<int64_t, GLushort>::iterator c = clusters.find(key);
+    if (c == clusters.end()) {
+      c = clusters.insert(make_pair(key, (GLushort)counts.size())).first;
+      vertices.resize(vertices.size()+6, 0);
+      counts.push_back(0);
+    }
+    GLfloat *sum = &vertices[6*c->second];
+    for (int i = 0; i < 6; ++i)
+      sum[i] += p[i];
+    counts[c->second] += 1;
+    clusterOf[v] = c->second;
+  }
+  for (size_t c = 0; c < counts.size(); ++c) {
+    GLfloat *v = &vertices[6*c];
+    for (int i = 0; i < 3; ++i)
+      v[i] /= counts[c];
+    GLfloat len = sqrt(v[3]*v[3] + v[4]*v[4] + v[5]*v[5]);
+    if (len > 0)
+      for (int i = 3; i < 6; ++i)
+        v[i] /= len;
+  }
+
+  for (vector<Group>::const_iterator g = source.groups.begin(); g != source.groups.end(); ++g) {
+    Group group = {g->material, (GLsizei)indices.size(), 0};
+    for (GLsizei i = g->first; i+2 < g->first + g->count; i += 3) {
+      const GLushort a = source.indices[i], b = source.indices[i+1], c = source.indices[i+2];
+      if ((clusterOf[a] == clusterOf[b]) || (clusterOf[b] == clusterOf[c]) || (clusterOf[a] == clusterOf[c]))
+        continue; // collapsed, corners of different clusters in one cell are kept to close sharp edges
+      indices.push_back(clusterOf[a]);
+      indices.push_back(clusterOf[b]);
+      indices.push_back(clusterOf[c]);
+    }
+    group.count = indices.size() - group.first;
+    if (group.count > 0)
+      groups.push_back(group);
+  }
+  sortGroups();
+}
+
+struct ModelHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t nbMaterials;
+  uint32_t nbGroups;
+  uint32_t nbVertices;
+  uint32_t nbIndices;
+};
+
+void IndexedModel::load(const char *resource)
+{
+  static boost::once_flag resourcesInitialized = BOOST_ONCE_INIT; // models are loaded by several worker threads
+  boost::call_once(&initModelResources, resourcesInitialized);
+  QFile file(resource);
+  if (!file.open(QIODevice::ReadOnly))
+    throw runtime_error(string("IndexedModel: resource not found: ") + resource);
+  const QByteArray blob = file.readAll(); // decompressed by QFile, whichever compression rcc chose (zlib or zstd)
+  const char *data = blob.constData();
+  const size_t size = blob.size();
+  ModelHeader h;
+  if (size < sizeof(h))
+    throw runtime_error(string("IndexedModel: invalid model ") + resource);
+  memcpy(&h, data, sizeof(h));
+  const size_t expected = sizeof(h) + h.nbMaterials*sizeof(Material) + h.nbGroups*sizeof(Group)
+                          + h.nbVertices*6*sizeof(GLfloat) + h.nbIndices*sizeof(GLushort);
+  if ((h.magic != MODEL_MAGIC) || (h.version != MODEL_VERSION) || (size != expected))
+    throw runtime_error(string("IndexedModel: invalid model ") + resource);
+  const char *p = data + sizeof(h);
+  materials.resize(h.nbMaterials);
+  groups.resize(h.nbGroups);
+  vertices.resize(h.nbVertices*6);
+  indices.resize(h.nbIndices);
+  if (h.nbMaterials) memcpy(&materials[0], p, h.nbMaterials*sizeof(Material));
+  p += h.nbMaterials*sizeof(Material);
+  if (h.nbGroups) memcpy(&groups[0], p, h.nbGroups*sizeof(Group));
+  p += h.nbGroups*sizeof(Group);
+  if (h.nbVertices) memcpy(&vertices[0], p, h.nbVertices*6*sizeof(GLfloat));
+  p += h.nbVertices*6*sizeof(GLfloat);
+  if (h.nbIndices) memcpy(&indices[0], p, h.nbIndices*sizeof(GLushort));
+  sortGroups();
+}
+
+void IndexedModel::save(const char *filename) const
+{
+  ModelHeader h = {MODEL_MAGIC, MODEL_VERSION, (uint32_t)materials.size(), (uint32_t)groups.size(), (uint32_t)nbVertices(), (uint32_t)indices.size()};
+  ofstream out(filename, ios::binary);
+  out.write((const char*)&h, sizeof(h));
+  if (!materials.empty()) out.write((const char*)&materials[0], materials.size()*sizeof(Material));
+  if (!groups.empty()) out.write((const char*)&groups[0], groups.size()*sizeof(Group));
+  if (!vertices.empty()) out.write((const char*)&vertices[0], vertices.size()*sizeof(GLfloat));
+  if (!indices.empty()) out.write((const char*)&indices[0], indices.size()*sizeof(GLushort));
+  if (!out)
+    throw runtime_error(string("IndexedModel: could not write ") + filename);
+}
+
+void IndexedModel::applyMaterial(const Material &m, const GLfloat *diffuse)
+{
+  glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, m.ambient);
+  if (diffuse) {
+    GLfloat d[4] = {diffuse[0], diffuse[1], diffuse[2], m.diffuse[3]};
+    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, d);
+  } else {
+    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, m.diffuse);
+  }
+  glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, m.specular);
+  glMaterialfv(GL_FRONT_AND_BACK, GL_EMISSION, m.emission);
+  glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, m.shininess);
+}
+
+bool IndexedModel::isTranslucent(const Group &g) const
+{
+  return materials[g.material].diffuse[3] < 1.0;
+}
+
+bool IndexedModel::hasGroups(int selection) const
+{
+  for (vector<Group>::const_iterator g = groups.begin(); g != groups.end(); ++g)
+    if (selection & (isTranslucent(*g) ? TRANSLUCENT_GROUPS : OPAQUE_GROUPS))
+      return true;
+  return false;
+}
+
+void IndexedModel::sortGroups()
+{
+  vector<Group> sorted;
+  sorted.reserve(groups.size());
+  for (vector<Group>::const_iterator g = groups.begin(); g != groups.end(); ++g)
+    if (!isTranslucent(*g))
+      sorted.push_back(*g);
+  for (vector<Group>::const_iterator g = groups.begin(); g != groups.end(); ++g)
+    if (isTranslucent(*g))
+      sorted.push_back(*g);
+  groups.swap(sorted);
+}
+
+bool IndexedModel::beginGroup(const Group &g, int selection, bool &blending)
+{
+  const bool translucent = isTranslucent(g);
+  if (!(selection & (translucent ? TRANSLUCENT_GROUPS : OPAQUE_GROUPS)))
+    return false;
+  if (translucent && !blending) { // translucent groups are sorted last, as in the translucent pass of MNavWidget
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+    blending = true;
+  }
+  return true;
+}
+
+size_t IndexedModel::gpuMemory() const
+{
+  if (!vertexBuffer.isCreated())
+    return 0;
+  return vertices.size()*sizeof(GLfloat) + indices.size()*sizeof(GLushort);
+}
+
+bool IndexedModel::upload()
+{
+  if (indices.empty())
+    return false;
+  if (!vertexBuffer.isCreated()) {
+    if (!vertexBuffer.create() || !indexBuffer.create())
+      return false;
+    vertexBuffer.setUsagePattern(QGLBuffer::StaticDraw);
+    vertexBuffer.bind();
+    vertexBuffer.allocate(&vertices[0], vertices.size()*sizeof(GLfloat));
+    vertexBuffer.release();
+    indexBuffer.setUsagePattern(QGLBuffer::StaticDraw);
+    indexBuffer.bind();
+    indexBuffer.allocate(&indices[0], indices.size()*sizeof(GLushort));
+    indexBuffer.release();
+  }
+  return true;
+}
+
+void IndexedModel::draw(int diffuseMaterial, const GLfloat *diffuse, int selection)
+{
+  if (!hasGroups(selection) || !upload())
+    return;
+  bool blending = false;
+  glPushAttrib(GL_ENABLE_BIT | GL_LIGHTING_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+  glDisable(GL_COLOR_MATERIAL);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_NORMAL_ARRAY);
+  vertexBuffer.bind();
+  glVertexPointer(3, GL_FLOAT, 6*sizeof(GLfloat), (const GLvoid*)0);
+  glNormalPointer(GL_FLOAT, 6*sizeof(GLfloat), (const GLvoid*)(3*sizeof(GLfloat)));
+  vertexBuffer.release();
+  indexBuffer.bind();
+  for (vector<Group>::const_iterator g = groups.begin(); g != groups.end(); ++g) {
+    if (!beginGroup(*g, selection, blending))
+      continue;
+    applyMaterial(materials[g->material], (g->material == diffuseMaterial) ? diffuse : NULL);
+    glDrawElements(GL_TRIANGLES, g->count, GL_UNSIGNED_SHORT, (const GLvoid*)(g->first*sizeof(GLushort)));
+  }
+  indexBuffer.release();
+  glPopClientAttrib();
+  glPopAttrib();
+}
+
+void IndexedModel::drawInstanced(QGLShaderProgram &program, Instancing::DrawElementsInstancedFunc drawElementsInstanced, GLsizei nbInstances, int instanceColorMaterial, int selection)
+{
+  if ((nbInstances <= 0) || !hasGroups(selection) || !upload())
+    return;
+  bool blending = false;
+  glPushAttrib(GL_ENABLE_BIT | GL_LIGHTING_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  glDisable(GL_COLOR_MATERIAL);
+  vertexBuffer.bind();
+  program.setAttributeBuffer("position", GL_FLOAT, 0, 3, 6*sizeof(GLfloat));
+  program.setAttributeBuffer("normal", GL_FLOAT, 3*sizeof(GLfloat), 3, 6*sizeof(GLfloat));
+  vertexBuffer.release();
+  program.enableAttributeArray("position");
+  program.enableAttributeArray("normal");
+  indexBuffer.bind();
+  for (vector<Group>::const_iterator g = groups.begin(); g != groups.end(); ++g) {
+    if (!beginGroup(*g, selection, blending))
+      continue;
+    applyMaterial(materials[g->material], NULL);
+    program.setUniformValue("useInstanceColor", (GLint)(g->material == instanceColorMaterial));
+    drawElementsInstanced(GL_TRIANGLES, g->count, GL_UNSIGNED_SHORT, (const GLvoid*)(g->first*sizeof(GLushort)), nbInstances);
+  }
+  indexBuffer.release();
+  program.disableAttributeArray("normal");
+  program.disableAttributeArray("position");
+  glPopAttrib();
+}
+
+} // namespace
+
+void generate_passat(Gui3DQt::IndexedModel &model)
+{
+  model.load(":/models/passat.bin");
+}
+
+void generate_tire(Gui3DQt::IndexedModel &model)
+{
+  model.load(":/models/tire.bin");
+}
+
+void generate_velodyne(Gui3DQt::IndexedModel &model)
+{
+  model.load(":/models/velodyne.bin");
+}
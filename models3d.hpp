@@ -31,12 +31,98 @@
 #ifdef WIN32
 #include <windows.h>
 #endif
+#include <vector>
 #include <GL/gl.h>
 #include <GL/glu.h>
+#include <QtOpenGL/QGLBuffer>
+#include "Instancing.hpp"
 
-GLint generate_passat(double r, double g, double b); // implemented in model3dpassat.cpp
-GLint generate_passatwagon(double passat_r, double passat_g, double passat_b); // implemented in model3dpassatwagon.cpp
-GLint generate_tire(void); // implemented in model3dtire.cpp
-GLint generate_velodyne(void); // implemented in model3dvelodyne.cpp
+class QGLShaderProgram;
+
+namespace Gui3DQt {
+
+/*!
+ * \class IndexedModel
+ * \brief A static model in an indexed vertex buffer, its triangles grouped by material
+ *
+ * The models exported by Deep Exploration store a position and a normal index per triangle
+ * corner. build() merges equal position/normal pairs into one vertex and sorts the
+ * triangles by material, so draw() needs one glDrawElements call per material.
+ * The buffers are uploaded on the first draw() (within the current GL context).
+ *
+ * The built-in models are stored in this layout as binary blobs (see save()) in the
+ * Qt resources of the library and are read by load() without any conversion.
+ * The blobs are written by tools/model2blob from the exports in models/src
+ * (cmake -DBUILD_MODEL_CONVERTER=ON, make models).
+ */
+class IndexedModel
+{
+public:
+  struct Material {
+    GLfloat ambient[4];
+    GLfloat diffuse[4];
+    GLfloat specular[4];
+    GLfloat emission[4];
+    GLfloat shininess;
+  };
+  struct Group {
+    int     material;
+    GLsizei first; //!< first index
+    GLsizei count; //!< number of indices
+  };
+
+  enum GroupSelection {OPAQUE_GROUPS = 1, TRANSLUCENT_GROUPS = 2, ALL_GROUPS = 3}; //!< translucent groups have a diffuse alpha < 1
+
+  IndexedModel();
+  ~IndexedModel();
+
+  //! appends a material, returns its number as referenced by build()
+  int addMaterial(const GLfloat ambient[3], const GLfloat diffuse[3], const GLfloat specular[3], const GLfloat emission[3], GLfloat alpha, GLfloat shininess);
+  //! converts faces {v0,v1,v2, n0,n1,n2, t0,t1,t2} and runs of {material,face count} into the indexed format
+  void build(const short (*faces)[9], size_t nbFaces, const GLfloat (*positions)[3], const GLfloat (*normals)[3], const int (*materialRuns)[2], size_t nbMaterialRuns);
+  //! replaces this model by a coarser version of source: vertices within a cell of the given size (and of similar normal direction) are merged, collapsed triangles are dropped
+  void simplify(const IndexedModel &source, GLfloat cellSize);
+  //! reads a blob written by save(), e.g. from the Qt resource ":/models/passat.bin", throws on errors
+  void load(const char *resource);
+  //! writes the model as blob: header, materials, groups, vertices, indices (native byte order)
+  void save(const char *filename) const;
+  /*! draws the selected groups with their materials, if diffuse is given it replaces the diffuse color of material diffuseMaterial.
+   *  Translucent groups are drawn after the opaque ones with blending and without depth writes
+   */
+  void draw(int diffuseMaterial = -1, const GLfloat *diffuse = NULL, int selection = ALL_GROUPS);
+  /*! draws nbInstances copies with the bound program, setting its attributes "position" and "normal".
+   *  The groups are drawn with their materials, the uniform "useInstanceColor" is 1 for material instanceColorMaterial and 0 otherwise
+   */
+  void drawInstanced(QGLShaderProgram &program, Instancing::DrawElementsInstancedFunc drawElementsInstanced, GLsizei nbInstances, int instanceColorMaterial = -1, int selection = ALL_GROUPS);
+  bool hasGroups(int selection) const; //!< whether any group matches the GroupSelection
+
+  size_t nbVertices() const {return vertices.size()/6;}
+  size_t nbTriangles() const {return indices.size()/3;}
+  GLfloat extent() const; //!< largest side of the bounding box
+  size_t gpuMemory() const; //!< bytes in the vertex and index buffer, 0 before the first draw
+
+  std::vector<GLfloat>  vertices; //!< x,y,z,nx,ny,nz per vertex
+  std::vector<GLushort> indices; //!< triangles, sorted by material
+  std::vector<Material> materials;
+  std::vector<Group>    groups; //!< one per used material, opaque ones first
+
+private:
+  QGLBuffer vertexBuffer;
+  QGLBuffer indexBuffer;
+
+  bool upload(); // creates the buffers on first use
+  bool isTranslucent(const Group &g) const;
+  void sortGroups(); // moves translucent groups to the end
+  bool beginGroup(const Group &g, int selection, bool &blending); // false if not selected, enables blending for the first translucent group
+  void applyMaterial(const Material &m, const GLfloat *diffuse);
+};
+
+} // namespace
+
+void generate_passat(Gui3DQt::IndexedModel &model); // loads models/passat.bin, material PASSAT_BODY_MATERIAL is the body
+void generate_tire(Gui3DQt::IndexedModel &model); // loads models/tire.bin
+void generate_velodyne(Gui3DQt::IndexedModel &model); // loads models/velodyne.bin
+
+const int PASSAT_BODY_MATERIAL = 2;
 
 #endif
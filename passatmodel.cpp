@@ -20,16 +20,19 @@
  *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "Gui3DQt/passatmodel.hpp"
+#include "Gui3DQt/GLState.hpp"
+#include "Gui3DQt/ModelAssets.hpp"
 
 #include <cmath>
 #include <stdexcept>
 #include "models3d.hpp"
 
-static GLint *passatwagon = NULL; // pointer to array of size [PASSAT_MODEL_COUNT]
-static GLint tire = 0;
-static GLint velodyne = 0;
-
 using namespace std;
+using Gui3DQt::IndexedModel;
+using Gui3DQt::ModelAssets;
+
+static GLfloat passatColor[Gui3DQt::PassatModel::PASSAT_MODEL_COUNT][3];
+static bool passatColorSet[Gui3DQt::PassatModel::PASSAT_MODEL_COUNT] = {false};
 
 // helper function for angle conversion
 double radians_to_degrees(double rad) {
@@ -42,85 +45,101 @@ void checkFailIndexRange(unsigned int model_index) {
     throw invalid_argument("passat model index invalid");
 }
 
-// helper function to init/verify static variables, colors are only used if model was not already loaded
-void assertPassatModel(unsigned int model_index, double r, double g, double b) {
-  if (passatwagon == NULL) { // init storage
-    passatwagon = new GLint[Gui3DQt::PassatModel::PASSAT_MODEL_COUNT];
-    for (unsigned int i=0; i<Gui3DQt::PassatModel::PASSAT_MODEL_COUNT; ++i) 
-      passatwagon[model_index] = 0;
+int Gui3DQt::PassatModel::levelOfDetail(double x, double y, double z)
+{
+  GLdouble view[16], projection[16];
+  GLint viewport[4];
+  GLState &state = GLState::current();
+  state.getViewMatrix(view);
+  state.getProjectionMatrix(projection);
+  state.getViewport(viewport);
+  double pixels = 5.0 * sqrt(view[0]*view[0] + view[1]*view[1] + view[2]*view[2])
+                  * projection[5] * viewport[3] / 2; // projected car length
+  if (projection[15] == 0) { // perspective
+    const double distance = -(view[2]*x + view[6]*y + view[10]*z + view[14]);
+    if (distance <= 0)
+      return 0;
+    pixels /= distance;
   }
-  if (!passatwagon[model_index])
-    passatwagon[model_index] = generate_passatwagon(r, g, b);
-  if (!tire)
-    tire = generate_tire();
-  if (!velodyne)
-    velodyne = generate_velodyne();
+  return ModelAssets::levelOfDetail(pixels);
 }
 
 
 void Gui3DQt::PassatModel::setColor(unsigned int model_index, double r, double g, double b) {
   checkFailIndexRange(model_index);
-  // if model exists, delete it
-  if (passatwagon != NULL) { // memory initialized
-    if (passatwagon[model_index] != 0) { // specified model was already loaded
-      glDeleteLists(passatwagon[model_index], 1);
-      passatwagon[model_index] = 0;
-    }
-  }
-  // generate model
-  assertPassatModel(model_index, r, g, b);
+  passatColor[model_index][0] = r;
+  passatColor[model_index][1] = g;
+  passatColor[model_index][2] = b;
+  passatColorSet[model_index] = true;
 }
 
 
-void Gui3DQt::PassatModel::draw(unsigned int model_index, double wheel_angle, double velodyne_angle)
-{
-  checkFailIndexRange(model_index);
-  assertPassatModel(model_index, 0.5, 0.5, 0.5);
-  GLboolean depthtestState, lightingState;
-  glGetBooleanv(GL_DEPTH_TEST, &depthtestState);
-  glGetBooleanv(GL_LIGHTING, &lightingState);
-  if (!depthtestState) glEnable(GL_DEPTH_TEST);
-  if (!lightingState) glEnable(GL_LIGHTING);
+// helper function drawing the parts of the selected material groups
+void drawParts(unsigned int model_index, double wheel_angle, double velodyne_angle, IndexedModel &passat, IndexedModel &tire, IndexedModel &velodyne, int groups) {
+  glPushMatrix();
   /* draw the license plates */
   glPushMatrix();
   glScalef(5.0, 5.0, 5.0);
   glRotatef(180,0,0,1);
-  glCallList(passatwagon[model_index]);
+  passat.draw(PASSAT_BODY_MATERIAL, passatColor[model_index], groups);
   glPopMatrix();
   glScalef(0.65, 0.65, 0.65);
   // Front Right Tire
   glPushMatrix();
   glTranslatef(2.27, -1.17, -0.86);
   glRotatef( radians_to_degrees(wheel_angle), 0, 1, 0 );
-  glCallList(tire);
+  tire.draw(-1, NULL, groups);
   glPopMatrix();
   // Front Left Tire
   glPushMatrix();
   glTranslatef(2.27, 1.17, -0.86);
   glRotatef(180, 0, 0, 1);
   glRotatef( -radians_to_degrees(wheel_angle), 0, 1, 0 );
-  glCallList(tire);
+  tire.draw(-1, NULL, groups);
   glPopMatrix();
   // Rear Right Tire
   glPushMatrix();
   glTranslatef(-2.05, -1.17, -0.86);
   glRotatef( radians_to_degrees(wheel_angle), 0, 1, 0 );
-  glCallList(tire);
+  tire.draw(-1, NULL, groups);
   glPopMatrix();
   // Rear Left Tire
   glPushMatrix();
   glTranslatef(-2.05, 1.17, -0.86);
   glRotatef(180, 0, 0, 1);
   glRotatef( -radians_to_degrees(wheel_angle), 0, 1, 0 );
-  glCallList(tire);
+  tire.draw(-1, NULL, groups);
   glPopMatrix();
   glScalef(0.35, 0.35, 0.35);
   // Velodyne laser
   glPushMatrix();
   glTranslatef(-0.34, 0, 3.6);
   glRotatef(radians_to_degrees(velodyne_angle) + 180, 0, 0, 1);
-  glCallList(velodyne);
+  velodyne.draw(-1, NULL, groups);
   glPopMatrix();
-  if (!depthtestState) glDisable(GL_DEPTH_TEST);
-  if (!lightingState) glDisable(GL_LIGHTING);
+  glPopMatrix();
+}
+
+
+void Gui3DQt::PassatModel::draw(unsigned int model_index, double wheel_angle, double velodyne_angle, DrawPass pass, int lod)
+{
+  checkFailIndexRange(model_index);
+  if (!passatColorSet[model_index])
+    setColor(model_index, 0.5, 0.5, 0.5);
+  ModelAssets &assets = ModelAssets::instance();
+  if ((lod < 0) || (lod >= ModelAssets::NB_LODS))
+    lod = 0;
+  boost::shared_ptr<IndexedModel> passat = assets.get(ModelAssets::PASSAT, lod);
+  boost::shared_ptr<IndexedModel> tire = assets.get(ModelAssets::TIRE, lod);
+  boost::shared_ptr<IndexedModel> velodyne = assets.get(ModelAssets::VELODYNE, lod);
+  if (!passat || !tire || !velodyne)
+    return;
+  glPushAttrib(GL_ENABLE_BIT);
+  glEnable(GL_DEPTH_TEST);
+  glEnable(GL_LIGHTING);
+  if (pass != TRANSLUCENT_PARTS)
+    drawParts(model_index, wheel_angle, velodyne_angle, *passat, *tire, *velodyne, IndexedModel::OPAQUE_GROUPS);
+  if (pass != OPAQUE_PARTS)
+    drawParts(model_index, wheel_angle, velodyne_angle, *passat, *tire, *velodyne, IndexedModel::TRANSLUCENT_GROUPS);
+  glPopAttrib();
 }
@@ -0,0 +1,52 @@
+/*
+ *  Gui3DQt - a lightweight, modular Gui framework for displaying 3D content
+ *  https://github.com/FrankMoosmann/Gui3DQt.git
+ *
+ *  \copyright  Karlsruhe Institute of Technology (KIT)
+ *              Institute of Measurement and Control Systems
+ *              http://www.mrt.kit.edu
+ *
+ *              This program is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              version 3 as published by the Free Software Foundation.
+ *              Other licenses are available on demand.
+ *
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *              You should have received a copy of the GNU General Public License
+ *              along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Converts a model exported by Deep Exploration (CPP export filter, see models/src)
+// into the blob read by IndexedModel::load(). The export is selected at compile time:
+//   MODEL_EXPORT="models/src/model3dpassat.cpp", its generate function is renamed to convert_model
+#define generate_passat   convert_model
+#define generate_tire     convert_model
+#define generate_velodyne convert_model
+#include MODEL_EXPORT
+
+#include <iostream>
+#include <exception>
+
+using namespace std;
+
+int main(int argc, char **argv)
+{
+  if (argc != 2) {
+    cerr << "usage: " << argv[0] << " <output.bin>" << endl;
+    return 1;
+  }
+  try {
+    Gui3DQt::IndexedModel model;
+    convert_model(model); // merges the position/normal pairs and groups the triangles by material
+    model.save(argv[1]);
+    cout << argv[1] << ": " << model.nbVertices() << " vertices, " << model.nbTriangles() << " triangles" << endl;
+  } catch (const exception &e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}